@@ -1,29 +1,950 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <dirent.h>
 #include <errno.h>
+#include <fcntl.h>
 #include <limits.h>
+#include <math.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdarg.h>
+#include <stdatomic.h>
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
 #include <time.h>
+#include <unistd.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
 
 #define MAX_LINE 8192
 #define MAX_ITERATION_BOUND 1000000
+#define OUTPUT_BUFFER_SIZE (1 << 20)
+#define MAX_THREADS 64
+#define PARALLEL_PARSE_MIN_BYTES (4u << 20)
+#define PARALLEL_REPLAY_MIN_BYTES (8u << 20)
+#define KEYFRAME_DEFAULT_INTERVAL 1024
+#define KEYFRAME_FULL_PERIOD 16
+#define KEYFRAME_MAGIC "PZLIDX3"
+#define CHECKPOINT_MAGIC "PZLCKP1"
+#define CHECKPOINT_DEFAULT_INTERVAL 60.0
+#define CHECKPOINT_POLL_MASK 0xFFFF
+#define SEARCH_ABORTED -2
+#define CACHE_DEFAULT_LIMIT (64ULL << 20)
+#define CACHE_SUFFIX ".moves"
+#define TABLE_MAGIC "PZLTT01"
+#define TABLE_DEFAULT_BITS 20
+#define HEURISTIC_VERSION 1
+#define TABLE_PRELOADED 1u
+#define TABLE_USED 2u
+#define PACK_MAGIC "PZLPACK1"
+#define MAX_PUZZLE_SIZE 46340
+#define PRINT_STATE_MAX_SIZE 512
+#define IDA_MAX_CELLS 16
+#define IDA_ATTEMPT_MAX_CELLS 100
+#define IDA_ATTEMPT_SECONDS 2.0
+#define WINDOW_MAX_CELLS 6
+#define WINDOW_MAX_STATES 256
+#define BENCH_DEFAULT_REPEAT 5
+#define BENCH_BASELINE_PATH "bench-baseline.json"
+#define COMPARE_MIN_SECONDS 0.001
+#define COUNTER_MAX_SLOTS 256
+#define PROGRESS_PUBLISH_MASK 0xFFF
+#define ESTIMATE_DEFAULT_PROBES 2000
+#define ESTIMATE_BUDGET_SECONDS 0.9
+#define ESTIMATE_MAX_CELLS 100
+#define ESTIMATE_MAX_BOUNDS 64
+#define ESTIMATE_HORIZON_SECONDS 86400.0
+#define ESTIMATE_SEARCH_SECONDS 0.4
+#define ESTIMATE_RATE_MIN_NODES 100000
+#define PROFILE_BFS_MAX_CELLS 9
+#define PROFILE_MAX_CELLS 16
+#define PROFILE_DEFAULT_SAMPLES 1000
+#define PROFILE_MAX_SCRAMBLE 60
+#define PROFILE_RATIO_BUCKETS 20
+#define PROFILE_TIMING_ROUNDS 16
+#define MICRO_WARMUP_RUNS 3
+#define MICRO_REPEATS 5
+#define MICRO_MIN_SECONDS 0.01
+#define MICRO_MOVE_COUNT (1u << 20)
+#define COUNTER_MAX_DEPTH 256
+
+typedef enum {
+    SOLVER_AUTO,
+    SOLVER_IDA,
+    SOLVER_CONSTRUCTIVE
+} SolverKind;
+
+typedef struct {
+    const char *checkpoint_path;
+    double checkpoint_interval;
+    const char *cache_dir;
+    unsigned long long cache_limit;
+    const char *table_path;
+    int table_bits;
+    uint64_t seed;
+    bool has_seed;
+    const char *out_dir;
+    const char *pack_path;
+    SolverKind solver;
+    const char *moves_path;
+    const char *report_path;
+    const char *iterations_path;
+    double progress_interval;
+    double ida_seconds;
+    double search_seconds;
+    double tolerance;
+    bool has_tolerance;
+    const char *trace_path;
+    const char *memory_path;
+    bool quiet;
+} Options;
+
+typedef struct {
+    bool solved;
+    unsigned long long length;
+    long long expanded;
+    int interrupted;
+} SolveStats;
+
+typedef struct {
+    const char *name;
+    int rows;
+    int cols;
+    int depth;
+    uint64_t seed;
+    SolverKind solver;
+} BenchCase;
+
+typedef struct {
+    double min;
+    double p50;
+    double p90;
+    double max;
+    double mean;
+} Summary;
+
+typedef struct {
+    const BenchCase *bench;
+    bool solved;
+    unsigned long long length;
+    long long expanded;
+    Summary wall;
+    Summary cpu;
+    double nodes_per_sec;
+    long peak_rss_kb;
+} BenchResult;
+
+typedef struct {
+    char name[64];
+    unsigned long long length;
+    long long expanded;
+    double wall_p50;
+    double wall_max;
+} BaselineEntry;
+
+typedef struct {
+    int rows;
+    int cols;
+    int len;
+    int *state;
+    int blank;
+    int *goal;
+    int *goal_pos;
+    int goal_blank;
+    char *moves;
+    size_t move_count;
+    char ini_path[PATH_MAX];
+    char moves_path[PATH_MAX];
+    char out_path[PATH_MAX];
+    volatile long long sink;
+} MicroFixture;
+
+typedef struct {
+    const char *name;
+    long long (*body)(MicroFixture *fixture, long long iterations);
+} MicroPrimitive;
+
+typedef struct {
+    uint64_t s[4];
+} Rng;
+
+typedef enum {
+    CORPUS_UNIFORM,
+    CORPUS_SCRAMBLE
+} CorpusKind;
 
 typedef struct {
+    CorpusKind kind;
+    const char *dir;
+    const char *pack_path;
+    int pack_fd;
     int n;
+    int depth;
+    uint64_t seed;
+    long long count;
+    atomic_llong next;
+    atomic_bool failed;
+    uint64_t *seeds;
+    unsigned char *parities;
+    char (*digests)[65];
+} Corpus;
+
+typedef struct {
+    char magic[8];
+    uint32_t n;
+    uint32_t reserved;
+    uint64_t count;
+} PackHeader;
+
+typedef struct {
+    uint64_t key;
+    int32_t h;
+    uint32_t flags;
+} TableEntry;
+
+typedef struct {
+    char magic[8];
+    uint32_t rows;
+    uint32_t heuristic_version;
+    uint32_t bits;
+    uint32_t cols;
+    uint64_t used;
+} TableHeader;
+
+typedef struct {
+    TableEntry *entries;
+    size_t mask;
+    void *mapping;
+    size_t mapping_size;
+    const char *path;
+    uint64_t preloaded;
+    uint64_t preloaded_used;
+    unsigned long long probes;
+    unsigned long long hits;
+    unsigned long long preloaded_hits;
+} TranspositionTable;
+
+typedef struct {
+    uint32_t h[8];
+    uint64_t length;
+    unsigned char block[64];
+    size_t used;
+} Sha256;
+
+typedef struct {
+    struct timespec mtime;
+    off_t size;
+    char name[80];
+} CacheEntry;
+
+typedef struct {
+    atomic_llong expanded;
+    atomic_llong iteration_start;
+    atomic_llong previous;
+    atomic_llong before_previous;
+    atomic_int bound;
+    bool done;
+    double interval;
+    double started;
+    pthread_mutex_t lock;
+    pthread_cond_t wake;
+} Progress;
+
+typedef struct {
+    int *pos;
+    int rows;
+    int cols;
     int len;
     long long expanded;
+    long long generated;
+    unsigned char *child;
+    int *level_min;
+    int resume_depth;
+    long long visits;
+    const char *checkpoint_path;
+    double checkpoint_interval;
+    double next_checkpoint;
+    uint64_t state_hash;
+    TranspositionTable *table;
+    uint64_t key;
+    Progress *progress;
+    double deadline;
 } SearchContext;
 
-static void print_state(const int *state, int n) {
-    for (int r = 0; r < n; r++) {
-        for (int c = 0; c < n; c++) {
+typedef struct {
+    const char *name;
+    const char *arg_name;
+    long long arg;
+    int tid;
+    double start_us;
+    double duration_us;
+} TraceEvent;
+
+typedef struct {
+    int bound;
+    int next_bound;
+    long long expanded;
+    long long generated;
+    double seconds;
+} IterationStats;
+
+typedef struct {
+    int bound;
+    int next_bound;
+    int probes;
+    bool goal;
+    bool solved;
+    double nodes;
+    double error;
+    double if_optimal;
+    long long searched;
+} BoundEstimate;
+
+typedef struct {
+    const char *name;
+    int (*evaluate)(const int *state, int rows, int cols, TranspositionTable *table);
+    bool needs_table;
+} HeuristicProfile;
+
+typedef struct {
+    char magic[8];
+    uint64_t state_hash;
+    int64_t expanded;
+    int32_t rows;
+    int32_t bound;
+    int32_t depth;
+    int32_t cols;
+} CheckpointHeader;
+
+typedef struct {
+    const char *data;
+    size_t size;
+    uint64_t mtime;
+} MappedFile;
+
+typedef struct {
+    const char *cursor;
+    const char *end;
+    size_t line;
+} MoveReader;
+
+typedef struct {
+    const char *begin;
+    const char *end;
+    int *state;
+    int *pos;
+    int len;
+    size_t offset;
+    size_t count;
+    _Atomic uint64_t *seen;
+    bool invalid;
+    int last_blank;
+} ParseChunk;
+
+typedef struct {
+    int32_t row;
+    int32_t col;
+    int32_t src_row;
+    int32_t src_col;
+} CellShift;
+
+typedef struct {
+    const char *begin;
+    const char *end;
+    int rows;
+    int cols;
+    size_t moves;
+    size_t lines;
+    int end_row;
+    int end_col;
+    int min_row;
+    int max_row;
+    int min_col;
+    int max_col;
+    bool out_of_bounds;
+    bool failed;
+    size_t *touched;
+    size_t touched_count;
+    CellShift *shifts;
+    size_t shift_count;
+} ReplayChunk;
+
+typedef struct {
+    int fd;
+    bool owns_fd;
+    bool failed;
+    size_t used;
+    char *data;
+} OutputBuffer;
+
+typedef struct {
+    uint64_t data_offset;
+    uint64_t move_offset;
+    uint64_t move_line;
+    int32_t blank_index;
+    uint32_t delta_count;
+} KeyframeEntry;
+
+typedef struct {
+    uint64_t table_offset;
+    uint64_t frame_count;
+    uint64_t move_count;
+    uint64_t moves_size;
+    uint64_t moves_mtime;
+    uint64_t state_hash;
+    uint32_t rows;
+    uint32_t cols;
+    uint32_t interval;
+    uint32_t reserved;
+    char magic[8];
+} KeyframeTrailer;
+
+typedef struct {
+    OutputBuffer out;
+    KeyframeEntry *entries;
+    size_t count;
+    size_t capacity;
+    uint64_t offset;
+    int *snapshot;
+    int *dirty;
+    size_t dirty_count;
+    int len;
+} KeyframeWriter;
+
+typedef struct {
+    int *state;
+    int *pos;
+    int rows;
+    int cols;
+    int blank;
+    int blank_row;
+    int blank_col;
+    int top;
+    int left;
+    int lock_col;
+    bool transposed;
+    int offsets[4];
+    int obstacles[2];
+    int obstacle_count;
+    unsigned int *visit;
+    unsigned int generation;
+    int *queue;
+    unsigned char *via;
+    unsigned char *route;
+    OutputBuffer out;
+    unsigned long long moves;
+} Reducer;
+
+typedef enum {
+    REPLAY_EMPTY,
+    REPLAY_APPLIED,
+    REPLAY_INVALID
+} ReplayResult;
+
+typedef enum {
+    MEM_BOARD,
+    MEM_PARSE,
+    MEM_PARITY,
+    MEM_MAPPED,
+    MEM_OUTPUT,
+    MEM_REPLAY,
+    MEM_SEARCH,
+    MEM_TABLE,
+    MEM_CACHE,
+    MEM_REDUCER,
+    MEM_CORPUS,
+    MEMORY_TAGS
+} MemoryTag;
+
+static const char *const memory_tag_names[MEMORY_TAGS] = {
+    "board", "parse", "parity", "mapped", "output", "replay", "search", "table", "cache",
+    "reducer", "corpus"
+};
+
+/* Slot MEMORY_TAGS holds the total across every tag. */
+static atomic_llong memory_current[MEMORY_TAGS + 1];
+static atomic_llong memory_peak[MEMORY_TAGS + 1];
+
+static void memory_raise(int slot, long long delta) {
+    long long current =
+        atomic_fetch_add_explicit(&memory_current[slot], delta, memory_order_relaxed) + delta;
+    long long peak = atomic_load_explicit(&memory_peak[slot], memory_order_relaxed);
+    while (current > peak &&
+           !atomic_compare_exchange_weak_explicit(&memory_peak[slot], &peak, current,
+                                                  memory_order_relaxed, memory_order_relaxed)) {
+    }
+}
+
+static void mem_account(MemoryTag tag, long long delta) {
+    memory_raise(tag, delta);
+    memory_raise(MEMORY_TAGS, delta);
+}
+
+/* Every tracked block carries its size and tag in a header so mem_free needs neither. */
+typedef struct {
+    size_t size;
+    size_t tag;
+} MemoryHeader;
+
+static void *mem_track(void *block, MemoryTag tag, size_t size) {
+    if (!block) {
+        return NULL;
+    }
+    MemoryHeader *header = block;
+    header->size = size;
+    header->tag = (size_t)tag;
+    mem_account(tag, (long long)size);
+    return header + 1;
+}
+
+static void *mem_alloc(MemoryTag tag, size_t size) {
+    if (size > SIZE_MAX - sizeof(MemoryHeader)) {
+        return NULL;
+    }
+    return mem_track(malloc(sizeof(MemoryHeader) + size), tag, size);
+}
+
+static void *mem_calloc(MemoryTag tag, size_t count, size_t size) {
+    if (size != 0 && count > (SIZE_MAX - sizeof(MemoryHeader)) / size) {
+        return NULL;
+    }
+    return mem_track(calloc(1, sizeof(MemoryHeader) + count * size), tag, count * size);
+}
+
+static void mem_free(void *ptr) {
+    if (!ptr) {
+        return;
+    }
+    MemoryHeader *header = (MemoryHeader *)ptr - 1;
+    mem_account((MemoryTag)header->tag, -(long long)header->size);
+    free(header);
+}
+
+static void *mem_realloc(MemoryTag tag, void *ptr, size_t size) {
+    if (!ptr) {
+        return mem_alloc(tag, size);
+    }
+    if (size > SIZE_MAX - sizeof(MemoryHeader)) {
+        return NULL;
+    }
+    MemoryHeader *header = (MemoryHeader *)ptr - 1;
+    size_t old_size = header->size;
+    MemoryTag old_tag = (MemoryTag)header->tag;
+    MemoryHeader *grown = realloc(header, sizeof(MemoryHeader) + size);
+    if (!grown) {
+        return NULL;
+    }
+    mem_account(old_tag, -(long long)old_size);
+    return mem_track(grown, tag, size);
+}
+
+#ifdef PUZZLE_COUNTERS
+typedef enum {
+    COUNTER_HEURISTIC,
+    COUNTER_MOVE_APPLIED,
+    COUNTER_MOVE_REJECTED,
+    COUNTER_REVERSE_PRUNED,
+    COUNTER_GOAL_CHECK,
+    COUNTER_KINDS
+} CounterId;
+
+typedef struct {
+    _Alignas(64) unsigned long long counts[COUNTER_KINDS];
+    unsigned long long depth[COUNTER_MAX_DEPTH];
+} CounterSlot;
+
+static const char *const counter_names[COUNTER_KINDS] = {
+    "heuristic evaluations", "IDA* moves applied", "IDA* moves rejected", "reverse-move prunes",
+    "goal checks"
+};
+
+/* Each thread claims its own padded slot on first use; threads past the last slot share it. */
+static CounterSlot counter_slots[COUNTER_MAX_SLOTS];
+static atomic_int counter_slot_count;
+static _Thread_local CounterSlot *counter_slot;
+
+static inline CounterSlot *counter_self(void) {
+    if (!counter_slot) {
+        int index = atomic_fetch_add_explicit(&counter_slot_count, 1, memory_order_relaxed);
+        counter_slot = &counter_slots[index < COUNTER_MAX_SLOTS ? index : COUNTER_MAX_SLOTS - 1];
+    }
+    return counter_slot;
+}
+
+#define COUNT(id) (counter_self()->counts[id]++)
+#define COUNT_DEPTH(level) \
+    (counter_self()->depth[(level) < COUNTER_MAX_DEPTH ? (level) : COUNTER_MAX_DEPTH - 1]++)
+
+static void counters_report(void) {
+    unsigned long long totals[COUNTER_KINDS] = {0};
+    unsigned long long depth[COUNTER_MAX_DEPTH] = {0};
+    int slots = atomic_load(&counter_slot_count);
+    if (slots > COUNTER_MAX_SLOTS) {
+        slots = COUNTER_MAX_SLOTS;
+    }
+    for (int i = 0; i < slots; i++) {
+        for (int k = 0; k < COUNTER_KINDS; k++) {
+            totals[k] += counter_slots[i].counts[k];
+        }
+        for (int d = 0; d < COUNTER_MAX_DEPTH; d++) {
+            depth[d] += counter_slots[i].depth[d];
+        }
+    }
+    fprintf(stderr, "Counters (%d threads):\n", slots);
+    for (int k = 0; k < COUNTER_KINDS; k++) {
+        fprintf(stderr, "  %-22s %llu\n", counter_names[k], totals[k]);
+    }
+    for (int d = 0; d < COUNTER_MAX_DEPTH; d++) {
+        if (depth[d] > 0) {
+            fprintf(stderr, "  expansions at depth %-3d%s %llu\n", d,
+                    d == COUNTER_MAX_DEPTH - 1 ? "+" : " ", depth[d]);
+        }
+    }
+}
+#else
+#define COUNT(id) ((void)0)
+#define COUNT_DEPTH(level) ((void)0)
+#endif
+
+static const char digit_pairs[201] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+static bool output_attach(OutputBuffer *out, int fd, bool owns_fd) {
+    out->fd = fd;
+    out->owns_fd = owns_fd;
+    out->failed = false;
+    out->used = 0;
+    out->data = mem_alloc(MEM_OUTPUT, OUTPUT_BUFFER_SIZE);
+    if (!out->data) {
+        if (owns_fd) {
+            close(fd);
+        }
+        return false;
+    }
+    return true;
+}
+
+static bool output_open(OutputBuffer *out, const char *path) {
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        return false;
+    }
+    return output_attach(out, fd, true);
+}
+
+static void output_writev(OutputBuffer *out, struct iovec *iov, int count) {
+    while (count > 0 && !out->failed) {
+        ssize_t written = writev(out->fd, iov, count);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            out->failed = true;
+            break;
+        }
+        size_t remaining = (size_t)written;
+        while (count > 0 && remaining >= iov->iov_len) {
+            remaining -= iov->iov_len;
+            iov++;
+            count--;
+        }
+        if (count > 0) {
+            iov->iov_base = (char *)iov->iov_base + remaining;
+            iov->iov_len -= remaining;
+        }
+    }
+}
+
+static void output_flush(OutputBuffer *out) {
+    if (out->used == 0) {
+        return;
+    }
+    struct iovec iov = {.iov_base = out->data, .iov_len = out->used};
+    output_writev(out, &iov, 1);
+    out->used = 0;
+}
+
+static void output_bytes(OutputBuffer *out, const void *data, size_t size) {
+    if (out->used + size <= OUTPUT_BUFFER_SIZE) {
+        memcpy(out->data + out->used, data, size);
+        out->used += size;
+        return;
+    }
+    if (size < OUTPUT_BUFFER_SIZE / 2) {
+        output_flush(out);
+        memcpy(out->data, data, size);
+        out->used = size;
+        return;
+    }
+    struct iovec iov[2] = {
+        {.iov_base = out->data, .iov_len = out->used},
+        {.iov_base = (void *)data, .iov_len = size}
+    };
+    output_writev(out, iov, 2);
+    out->used = 0;
+}
+
+static inline void output_reserve(OutputBuffer *out, size_t size) {
+    if (out->used + size > OUTPUT_BUFFER_SIZE) {
+        output_flush(out);
+    }
+}
+
+static inline void output_char(OutputBuffer *out, char c) {
+    output_reserve(out, 1);
+    out->data[out->used++] = c;
+}
+
+static void output_int(OutputBuffer *out, long long value) {
+    char digits[24];
+    char *end = digits + sizeof(digits);
+    char *ptr = end;
+    unsigned long long magnitude = value < 0 ? 0ULL - (unsigned long long)value
+                                             : (unsigned long long)value;
+    while (magnitude >= 100) {
+        unsigned int pair = (unsigned int)(magnitude % 100) * 2;
+        magnitude /= 100;
+        ptr -= 2;
+        ptr[0] = digit_pairs[pair];
+        ptr[1] = digit_pairs[pair + 1];
+    }
+    if (magnitude >= 10) {
+        unsigned int pair = (unsigned int)magnitude * 2;
+        ptr -= 2;
+        ptr[0] = digit_pairs[pair];
+        ptr[1] = digit_pairs[pair + 1];
+    } else {
+        *--ptr = (char)('0' + magnitude);
+    }
+    if (value < 0) {
+        *--ptr = '-';
+    }
+
+    size_t size = (size_t)(end - ptr);
+    output_reserve(out, size);
+    memcpy(out->data + out->used, ptr, size);
+    out->used += size;
+}
+
+static void output_format(OutputBuffer *out, const char *format, ...) {
+    char line[512];
+    va_list args;
+    va_start(args, format);
+    int size = vsnprintf(line, sizeof(line), format, args);
+    va_end(args);
+    if (size > 0) {
+        output_bytes(out, line, (size_t)size < sizeof(line) ? (size_t)size : sizeof(line) - 1);
+    }
+}
+
+static bool output_close(OutputBuffer *out) {
+    output_flush(out);
+    if (out->owns_fd && close(out->fd) != 0) {
+        out->failed = true;
+    }
+    mem_free(out->data);
+    out->data = NULL;
+    return !out->failed;
+}
+
+static void output_state(OutputBuffer *out, const int *state, int rows, int cols) {
+    for (int r = 0; r < rows; r++) {
+        const int *row = state + (size_t)r * (size_t)cols;
+        for (int c = 0; c < cols; c++) {
             if (c > 0) {
-                printf(",");
+                output_char(out, ',');
             }
-            printf("%d", state[r * n + c]);
+            output_int(out, row[c]);
         }
-        printf("\n");
+        output_char(out, '\n');
+    }
+}
+
+static void print_state(const int *state, int rows, int cols) {
+    if (rows > PRINT_STATE_MAX_SIZE || cols > PRINT_STATE_MAX_SIZE) {
+        printf("(%dx%d board not printed)\n", rows, cols);
+        return;
+    }
+    fflush(stdout);
+    OutputBuffer out;
+    if (!output_attach(&out, STDOUT_FILENO, false)) {
+        fprintf(stderr, "Failed to allocate output buffer.\n");
+        return;
+    }
+    output_state(&out, state, rows, cols);
+    output_close(&out);
+}
+
+static double monotonic_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+/* Trace events are kept in memory while the program runs and written once at exit. */
+static const char *trace_path;
+static double trace_origin;
+static TraceEvent *trace_events;
+static size_t trace_count;
+static size_t trace_capacity;
+static pthread_mutex_t trace_lock = PTHREAD_MUTEX_INITIALIZER;
+static atomic_int trace_next_tid = 1;
+static _Thread_local int trace_tid;
+
+static inline double trace_begin(void) {
+    return trace_path ? monotonic_seconds() : 0.0;
+}
+
+static void trace_end(const char *name, double started, const char *arg_name, long long arg) {
+    if (!trace_path) {
+        return;
+    }
+    double finished = monotonic_seconds();
+    if (trace_tid == 0) {
+        trace_tid = atomic_fetch_add(&trace_next_tid, 1);
+    }
+    pthread_mutex_lock(&trace_lock);
+    if (trace_count == trace_capacity) {
+        size_t capacity = trace_capacity ? trace_capacity * 2 : 256;
+        TraceEvent *grown = realloc(trace_events, sizeof(TraceEvent) * capacity);
+        if (grown) {
+            trace_events = grown;
+            trace_capacity = capacity;
+        }
+    }
+    if (trace_count < trace_capacity) {
+        trace_events[trace_count++] = (TraceEvent){
+            .name = name,
+            .arg_name = arg_name,
+            .arg = arg,
+            .tid = trace_tid,
+            .start_us = (started - trace_origin) * 1e6,
+            .duration_us = (finished - started) * 1e6
+        };
+    }
+    pthread_mutex_unlock(&trace_lock);
+}
+
+static void trace_write(void) {
+    OutputBuffer out;
+    if (!output_open(&out, trace_path)) {
+        fprintf(stderr, "Failed to write %s: %s\n", trace_path, strerror(errno));
+        return;
+    }
+    int pid = (int)getpid();
+    int threads = atomic_load(&trace_next_tid);
+    static const char header[] = "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n";
+    output_bytes(&out, header, sizeof(header) - 1);
+    output_format(&out, "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": %d, \"tid\": 1, "
+                        "\"args\": {\"name\": \"main\"}}\n", pid);
+    for (int tid = 2; tid < threads; tid++) {
+        output_format(&out, ",{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": %d, "
+                            "\"tid\": %d, \"args\": {\"name\": \"worker %d\"}}\n",
+                      pid, tid, tid - 1);
+    }
+    for (size_t i = 0; i < trace_count; i++) {
+        const TraceEvent *event = &trace_events[i];
+        output_format(&out, ",{\"name\": \"%s\", \"ph\": \"X\", \"pid\": %d, \"tid\": %d, "
+                            "\"ts\": %.3f, \"dur\": %.3f", event->name, pid, event->tid,
+                      event->start_us, event->duration_us);
+        if (event->arg_name) {
+            output_format(&out, ", \"args\": {\"%s\": %lld}", event->arg_name, event->arg);
+        }
+        output_bytes(&out, "}\n", 2);
+    }
+    output_bytes(&out, "]}\n", 3);
+    if (!output_close(&out)) {
+        fprintf(stderr, "Failed to write %s: %s\n", trace_path, strerror(errno));
+    }
+    free(trace_events);
+}
+
+static void trace_start(const char *path) {
+    trace_path = path;
+    trace_origin = monotonic_seconds();
+    trace_tid = atomic_fetch_add(&trace_next_tid, 1);
+    atexit(trace_write);
+}
+
+static long proc_status_kb(const char *field) {
+    FILE *status = fopen("/proc/self/status", "r");
+    if (!status) {
+        return -1;
+    }
+    char line[256];
+    size_t field_len = strlen(field);
+    long value = -1;
+    while (fgets(line, sizeof(line), status)) {
+        if (strncmp(line, field, field_len) == 0 && line[field_len] == ':') {
+            value = atol(line + field_len + 1);
+            break;
+        }
+    }
+    fclose(status);
+    return value;
+}
+
+static long peak_rss_kb(void) {
+    return proc_status_kb("VmHWM");
+}
+
+static const char *memory_report_path;
+
+static void memory_report(void) {
+    long long current[MEMORY_TAGS + 1];
+    long long peak[MEMORY_TAGS + 1];
+    for (int tag = 0; tag <= MEMORY_TAGS; tag++) {
+        current[tag] = atomic_load(&memory_current[tag]);
+        peak[tag] = atomic_load(&memory_peak[tag]);
+    }
+    long peak_rss = peak_rss_kb();
+    long rss = proc_status_kb("VmRSS");
+    if (strcmp(memory_report_path, "table") == 0) {
+        fprintf(stderr, "%-10s %16s %16s\n", "memory", "current bytes", "peak bytes");
+        for (int tag = 0; tag <= MEMORY_TAGS; tag++) {
+            if (peak[tag] == 0 && tag < MEMORY_TAGS) {
+                continue;
+            }
+            fprintf(stderr, "%-10s %16lld %16lld\n",
+                    tag < MEMORY_TAGS ? memory_tag_names[tag] : "total", current[tag], peak[tag]);
+        }
+        fprintf(stderr, "Process RSS: %ld KiB, peak %ld KiB.\n", rss, peak_rss);
+        return;
+    }
+
+    OutputBuffer out;
+    if (!output_open(&out, memory_report_path)) {
+        fprintf(stderr, "Failed to write %s: %s\n", memory_report_path, strerror(errno));
+        return;
+    }
+    output_bytes(&out, "{\n  \"tags\": {\n", 14);
+    for (int tag = 0; tag <= MEMORY_TAGS; tag++) {
+        output_format(&out, "    \"%s\": {\"current\": %lld, \"peak\": %lld}%s\n",
+                      tag < MEMORY_TAGS ? memory_tag_names[tag] : "total", current[tag],
+                      peak[tag], tag < MEMORY_TAGS ? "," : "");
+    }
+    output_format(&out, "  },\n  \"rss_kb\": %ld,\n  \"peak_rss_kb\": %ld\n}\n", rss,
+                  peak_rss);
+    if (!output_close(&out)) {
+        fprintf(stderr, "Failed to write %s: %s\n", memory_report_path, strerror(errno));
     }
 }
 
@@ -47,24 +968,36 @@ static int count_misplaced(const int *state, int len) {
     return misplaced;
 }
 
-static int manhattan_distance(const int *state, int n) {
-    int len = n * n;
-    int distance = 0;
+static inline long long manhattan_cells(const int *state, int len, int cols) {
+    long long distance = 0;
     for (int idx = 0; idx < len; idx++) {
         int value = state[idx];
         if (value == -1) {
             continue;
         }
-        int goal_row = value / n;
-        int goal_col = value % n;
-        int cur_row = idx / n;
-        int cur_col = idx % n;
+        int goal_row = value / cols;
+        int goal_col = value % cols;
+        int cur_row = idx / cols;
+        int cur_col = idx % cols;
         distance += abs(goal_row - cur_row) + abs(goal_col - cur_col);
     }
     return distance;
 }
 
+/* Boards past ~1000 per side sum beyond int, so callers narrow only once the bound is checked. */
+static long long manhattan_distance(const int *state, int rows, int cols) {
+    COUNT(COUNTER_HEURISTIC);
+    if (rows == cols && cols == 3) {
+        return manhattan_cells(state, 9, 3);
+    }
+    if (rows == cols && cols == 4) {
+        return manhattan_cells(state, 16, 4);
+    }
+    return manhattan_cells(state, rows * cols, cols);
+}
+
 static bool is_goal(const int *state, int len) {
+    COUNT(COUNTER_GOAL_CHECK);
     for (int i = 0; i < len - 1; i++) {
         if (state[i] != i) {
             return false;
@@ -73,6 +1006,23 @@ static bool is_goal(const int *state, int len) {
     return state[len - 1] == -1;
 }
 
+static inline uint64_t mix64(uint64_t x) {
+    x += 0x9E3779B97F4A7C15ULL;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+
+static uint64_t hash_state(const int *state, int len) {
+    uint64_t hash = 1469598103934665603ULL;
+    const unsigned char *bytes = (const unsigned char *)state;
+    for (size_t i = 0; i < sizeof(int) * (size_t)len; i++) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
 static char opposite_move(char move) {
     switch (move) {
         case 'U':
@@ -88,9 +1038,9 @@ static char opposite_move(char move) {
     }
 }
 
-static bool apply_move(int *state, int n, int *blank_index, char move) {
-    int row = *blank_index / n;
-    int col = *blank_index % n;
+static bool apply_move(int *state, int *pos, int rows, int cols, int *blank_index, char move) {
+    int row = *blank_index / cols;
+    int col = *blank_index % cols;
     int new_row = row;
     int new_col = col;
 
@@ -111,185 +1061,697 @@ static bool apply_move(int *state, int n, int *blank_index, char move) {
             return false;
     }
 
-    if (new_row < 0 || new_row >= n || new_col < 0 || new_col >= n) {
+    if (new_row < 0 || new_row >= rows || new_col < 0 || new_col >= cols) {
         return false;
     }
 
-    int new_index = new_row * n + new_col;
+    int new_index = new_row * cols + new_col;
     int temp = state[new_index];
     state[new_index] = -1;
     state[*blank_index] = temp;
+    if (pos) {
+        pos[temp] = *blank_index;
+    }
     *blank_index = new_index;
     return true;
 }
 
-static bool read_ini(const char *path, int **out_state, int *out_n, int *out_blank) {
-    FILE *file = fopen(path, "r");
-    if (!file) {
-        fprintf(stderr, "Failed to open %s: %s\n", path, strerror(errno));
+static bool map_file(const char *path, MappedFile *file) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
         return false;
     }
-
-    char line[MAX_LINE];
-    if (!fgets(line, sizeof(line), file)) {
-        fprintf(stderr, "ini.txt is empty.\n");
-        fclose(file);
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
         return false;
     }
 
-    int n = atoi(line);
-    if (n <= 0) {
-        fprintf(stderr, "Invalid puzzle size in ini.txt.\n");
-        fclose(file);
-        return false;
+    file->data = NULL;
+    file->size = (size_t)st.st_size;
+    file->mtime = (uint64_t)st.st_mtim.tv_sec * 1000000000ULL + (uint64_t)st.st_mtim.tv_nsec;
+    if (file->size > 0) {
+        void *map = mmap(NULL, file->size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (map == MAP_FAILED) {
+            close(fd);
+            return false;
+        }
+        posix_madvise(map, file->size, POSIX_MADV_SEQUENTIAL);
+        file->data = map;
+        mem_account(MEM_MAPPED, (long long)file->size);
     }
+    close(fd);
+    return true;
+}
 
-    int len = n * n;
-    int *state = malloc(sizeof(int) * (size_t)len);
-    if (!state) {
-        fprintf(stderr, "Failed to allocate puzzle state.\n");
-        fclose(file);
-        return false;
+static void unmap_file(MappedFile *file) {
+    if (file->data) {
+        munmap((void *)file->data, file->size);
+        mem_account(MEM_MAPPED, -(long long)file->size);
     }
+    file->data = NULL;
+    file->size = 0;
+}
 
-    int index = 0;
-    int blank_index = -1;
-
-    while (fgets(line, sizeof(line), file)) {
-        char *token = strtok(line, ",\n\r");
-        while (token) {
-            if (index >= len) {
-                fprintf(stderr, "Too many values in ini.txt.\n");
-                free(state);
-                fclose(file);
-                return false;
-            }
-            int value = atoi(token);
-            state[index] = value;
-            if (value == -1) {
-                blank_index = index;
-            }
-            index++;
-            token = strtok(NULL, ",\n\r");
-        }
+static int hardware_threads(void) {
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    if (count < 1) {
+        return 1;
     }
-    fclose(file);
+    return count > MAX_THREADS ? MAX_THREADS : (int)count;
+}
 
-    if (index != len) {
-        fprintf(stderr, "Expected %d values in ini.txt, got %d.\n", len, index);
-        free(state);
+static inline bool is_value_delimiter(char c) {
+    return c == ',' || c == '\n' || c == '\r';
+}
+
+static const char *next_token(const char *ptr, const char *end, const char **token_end) {
+    while (ptr < end && is_value_delimiter(*ptr)) {
+        ptr++;
+    }
+    if (ptr == end) {
+        return NULL;
+    }
+    const char *stop = ptr;
+    while (stop < end && !is_value_delimiter(*stop)) {
+        stop++;
+    }
+    *token_end = stop;
+    return ptr;
+}
+
+static int parse_int(const char *ptr, const char *end) {
+    while (ptr < end && (*ptr == ' ' || *ptr == '\t' || *ptr == '\v' || *ptr == '\f')) {
+        ptr++;
+    }
+    bool negative = false;
+    if (ptr < end && (*ptr == '-' || *ptr == '+')) {
+        negative = *ptr == '-';
+        ptr++;
+    }
+    long long value = 0;
+    while (ptr < end && *ptr >= '0' && *ptr <= '9') {
+        if (value <= INT_MAX) {
+            value = value * 10 + (*ptr - '0');
+        }
+        ptr++;
+    }
+    if (value > INT_MAX) {
+        value = INT_MAX;
+    }
+    return negative ? (int)-value : (int)value;
+}
+
+static size_t count_tokens(const char *ptr, const char *end) {
+    size_t count = 0;
+    const char *token_end;
+    while ((ptr = next_token(ptr, end, &token_end)) != NULL) {
+        count++;
+        ptr = token_end;
+    }
+    return count;
+}
+
+static inline size_t tile_slot(int value, int len) {
+    return value == -1 ? (size_t)len - 1 : (size_t)value;
+}
+
+static inline bool is_tile_value(int value, int len) {
+    return value == -1 || (value >= 0 && value < len - 1);
+}
+
+static bool validate_tiles(const int *state, int *pos, int len, int *out_blank) {
+    uint64_t *seen = mem_calloc(MEM_PARSE, ((size_t)len + 63) / 64, sizeof(uint64_t));
+    if (!seen) {
+        fprintf(stderr, "Failed to allocate tile check.\n");
         return false;
     }
+    int blank_index = -1;
+    for (int i = 0; i < len; i++) {
+        int value = state[i];
+        if (!is_tile_value(value, len)) {
+            fprintf(stderr, "Invalid tile %d at position %d in ini.txt.\n", value, i);
+            mem_free(seen);
+            return false;
+        }
+        size_t slot = tile_slot(value, len);
+        uint64_t bit = 1ULL << (slot % 64);
+        if (seen[slot / 64] & bit) {
+            fprintf(stderr, "Tile %d appears more than once in ini.txt.\n", value);
+            mem_free(seen);
+            return false;
+        }
+        seen[slot / 64] |= bit;
+        if (value == -1) {
+            blank_index = i;
+        } else {
+            pos[value] = i;
+        }
+    }
+    mem_free(seen);
+
     if (blank_index == -1) {
         fprintf(stderr, "Blank tile (-1) not found in ini.txt.\n");
-        free(state);
         return false;
     }
+    *out_blank = blank_index;
+    return true;
+}
 
-    *out_state = state;
-    *out_n = n;
+static bool parse_values_serial(const char *ptr, const char *end, int *state, int *pos,
+                                int len, int *out_blank) {
+    int index = 0;
+    const char *token_end;
+    while ((ptr = next_token(ptr, end, &token_end)) != NULL) {
+        if (index >= len) {
+            fprintf(stderr, "Too many values in ini.txt.\n");
+            return false;
+        }
+        state[index++] = parse_int(ptr, token_end);
+        ptr = token_end;
+    }
+    if (index != len) {
+        fprintf(stderr, "Expected %d values in ini.txt, got %d.\n", len, index);
+        return false;
+    }
+    return validate_tiles(state, pos, len, out_blank);
+}
+
+static void *count_chunk_worker(void *arg) {
+    ParseChunk *chunk = arg;
+    chunk->count = count_tokens(chunk->begin, chunk->end);
+    return NULL;
+}
+
+static void *parse_chunk_worker(void *arg) {
+    ParseChunk *chunk = arg;
+    double traced = trace_begin();
+    int *out = chunk->state + chunk->offset;
+    int len = chunk->len;
+    const char *ptr = chunk->begin;
+    const char *token_end;
+    size_t index = 0;
+    while ((ptr = next_token(ptr, chunk->end, &token_end)) != NULL) {
+        int value = parse_int(ptr, token_end);
+        out[index] = value;
+        if (!is_tile_value(value, len)) {
+            chunk->invalid = true;
+        } else {
+            size_t slot = tile_slot(value, len);
+            uint64_t bit = 1ULL << (slot % 64);
+            uint64_t prior = atomic_fetch_or_explicit(&chunk->seen[slot / 64], bit,
+                                                      memory_order_relaxed);
+            if (prior & bit) {
+                chunk->invalid = true;
+            }
+            if (value == -1) {
+                chunk->last_blank = (int)(chunk->offset + index);
+            } else {
+                chunk->pos[value] = (int)(chunk->offset + index);
+            }
+        }
+        index++;
+        ptr = token_end;
+    }
+    trace_end("parse_chunk", traced, "values", (long long)index);
+    return NULL;
+}
+
+static const char *line_split(const char *begin, const char *end, const char *cursor, int index,
+                              int count) {
+    if (index == count - 1) {
+        return end;
+    }
+    const char *stop = begin + (size_t)(end - begin) / (size_t)count * (size_t)(index + 1);
+    if (stop < cursor) {
+        stop = cursor;
+    }
+    if (stop < end) {
+        const char *newline = memchr(stop, '\n', (size_t)(end - stop));
+        stop = newline ? newline + 1 : end;
+    }
+    return stop;
+}
+
+static void run_workers(void *items, size_t item_size, int count, void *(*worker)(void *)) {
+    pthread_t threads[MAX_THREADS];
+    char *base = items;
+    int started = 0;
+    for (int i = 1; i < count; i++) {
+        if (pthread_create(&threads[i], NULL, worker, base + item_size * (size_t)i) != 0) {
+            break;
+        }
+        started = i;
+    }
+    worker(base);
+    for (int i = started + 1; i < count; i++) {
+        worker(base + item_size * (size_t)i);
+    }
+    for (int i = 1; i <= started; i++) {
+        pthread_join(threads[i], NULL);
+    }
+}
+
+static bool parse_values_parallel(const char *begin, const char *end, int *state, int *pos,
+                                  int len, int thread_count, int *out_blank) {
+    ParseChunk chunks[MAX_THREADS];
+    const char *cursor = begin;
+    for (int i = 0; i < thread_count; i++) {
+        const char *stop = line_split(begin, end, cursor, i, thread_count);
+        chunks[i] = (ParseChunk){
+            .begin = cursor,
+            .end = stop,
+            .state = state,
+            .pos = pos,
+            .len = len,
+            .last_blank = -1
+        };
+        cursor = stop;
+    }
+
+    run_workers(chunks, sizeof(ParseChunk), thread_count, count_chunk_worker);
+    size_t total = 0;
+    for (int i = 0; i < thread_count; i++) {
+        chunks[i].offset = total;
+        total += chunks[i].count;
+    }
+    if (total > (size_t)len) {
+        fprintf(stderr, "Too many values in ini.txt.\n");
+        return false;
+    }
+    if (total != (size_t)len) {
+        fprintf(stderr, "Expected %d values in ini.txt, got %zu.\n", len, total);
+        return false;
+    }
+
+    _Atomic uint64_t *seen = mem_calloc(MEM_PARSE, ((size_t)len + 63) / 64, sizeof(*seen));
+    if (!seen) {
+        fprintf(stderr, "Failed to allocate tile check.\n");
+        return false;
+    }
+    for (int i = 0; i < thread_count; i++) {
+        chunks[i].seen = seen;
+    }
+    run_workers(chunks, sizeof(ParseChunk), thread_count, parse_chunk_worker);
+    mem_free(seen);
+
+    int blank_index = -1;
+    for (int i = 0; i < thread_count; i++) {
+        if (chunks[i].invalid) {
+            return validate_tiles(state, pos, len, out_blank);
+        }
+        if (chunks[i].last_blank > blank_index) {
+            blank_index = chunks[i].last_blank;
+        }
+    }
+    if (blank_index == -1) {
+        fprintf(stderr, "Blank tile (-1) not found in ini.txt.\n");
+        return false;
+    }
     *out_blank = blank_index;
     return true;
 }
 
-static bool read_moves(const char *path, char **out_moves, size_t *out_count) {
-    FILE *file = fopen(path, "r");
-    if (!file) {
+static bool read_ini(const char *path, int **out_state, int **out_pos, int *out_rows,
+                     int *out_cols, int *out_blank) {
+    MappedFile file;
+    if (!map_file(path, &file)) {
+        fprintf(stderr, "Failed to open %s: %s\n", path, strerror(errno));
+        return false;
+    }
+    if (file.size == 0) {
+        fprintf(stderr, "ini.txt is empty.\n");
+        unmap_file(&file);
         return false;
     }
 
-    char line[MAX_LINE];
-    size_t capacity = 64;
-    size_t count = 0;
-    char *moves = malloc(capacity);
-    if (!moves) {
-        fclose(file);
+    const char *end = file.data + file.size;
+    const char *body = memchr(file.data, '\n', file.size);
+    body = body ? body + 1 : end;
+    const char *token_end = body;
+    const char *token = next_token(file.data, body, &token_end);
+    int rows = token ? parse_int(token, token_end) : 0;
+    int cols = rows;
+    if (token && (token = next_token(token_end, body, &token_end)) != NULL) {
+        cols = parse_int(token, token_end);
+    }
+    /* With a side of 1 no tile can pass another, so the parity check would not hold. */
+    if (rows < 2 || cols < 2 || rows > MAX_PUZZLE_SIZE || cols > MAX_PUZZLE_SIZE) {
+        fprintf(stderr, "Invalid puzzle size in ini.txt: sides must be between 2 and %d.\n",
+                MAX_PUZZLE_SIZE);
+        unmap_file(&file);
+        return false;
+    }
+
+    int len = rows * cols;
+    int *state = mem_alloc(MEM_BOARD, sizeof(int) * (size_t)len);
+    int *pos = mem_alloc(MEM_BOARD, sizeof(int) * (size_t)len);
+    if (!state || !pos) {
+        fprintf(stderr, "Failed to allocate puzzle state.\n");
+        mem_free(state);
+        mem_free(pos);
+        unmap_file(&file);
+        return false;
+    }
+
+    int blank_index = -1;
+    int thread_count = hardware_threads();
+    bool parsed;
+    if (thread_count > 1 && (size_t)(end - body) >= PARALLEL_PARSE_MIN_BYTES) {
+        parsed = parse_values_parallel(body, end, state, pos, len, thread_count, &blank_index);
+    } else {
+        parsed = parse_values_serial(body, end, state, pos, len, &blank_index);
+    }
+    unmap_file(&file);
+    if (!parsed) {
+        mem_free(state);
+        mem_free(pos);
         return false;
     }
 
-    while (fgets(line, sizeof(line), file)) {
-        char *ptr = line;
-        while (*ptr == ' ' || *ptr == '\t') {
+    *out_state = state;
+    *out_pos = pos;
+    *out_rows = rows;
+    *out_cols = cols;
+    *out_blank = blank_index;
+    return true;
+}
+
+static void move_reader_init(MoveReader *reader, const char *data, size_t size) {
+    reader->cursor = data;
+    reader->end = data + size;
+    reader->line = 0;
+}
+
+static bool next_move(MoveReader *reader, char *out_move) {
+    while (reader->cursor < reader->end) {
+        const char *ptr = reader->cursor;
+        const char *newline = memchr(ptr, '\n', (size_t)(reader->end - ptr));
+        reader->cursor = newline ? newline + 1 : reader->end;
+        reader->line++;
+
+        while (ptr < reader->cursor && (*ptr == ' ' || *ptr == '\t')) {
             ptr++;
         }
-        if (*ptr == '\0' || *ptr == '\n' || *ptr == '\r') {
+        if (ptr == reader->cursor) {
             continue;
         }
         char move = *ptr;
         if (move == 'U' || move == 'D' || move == 'L' || move == 'R') {
-            if (count == capacity) {
-                capacity *= 2;
-                char *new_moves = realloc(moves, capacity);
-                if (!new_moves) {
-                    free(moves);
-                    fclose(file);
-                    return false;
+            *out_move = move;
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool track_cell(ReplayChunk *chunk, int32_t *window, size_t cell, size_t src,
+                       size_t *capacity) {
+    if (window[cell] == 0) {
+        if (chunk->touched_count == *capacity) {
+            size_t grown = *capacity ? *capacity * 2 : 1024;
+            size_t *touched = mem_realloc(MEM_REPLAY, chunk->touched, sizeof(size_t) * grown);
+            if (!touched) {
+                return false;
+            }
+            chunk->touched = touched;
+            *capacity = grown;
+        }
+        chunk->touched[chunk->touched_count++] = cell;
+    }
+    window[cell] = (int32_t)src + 1;
+    return true;
+}
+
+static void *replay_chunk_worker(void *arg) {
+    ReplayChunk *chunk = arg;
+    double traced = trace_begin();
+    size_t span = 2 * (size_t)chunk->cols - 1;
+    size_t height = 2 * (size_t)chunk->rows - 1;
+    int32_t *window = NULL;
+    if (span * height < INT32_MAX) {
+        window = mem_calloc(MEM_REPLAY, span * height, sizeof(int32_t));
+    }
+    if (!window) {
+        chunk->failed = true;
+        return NULL;
+    }
+
+    MoveReader reader;
+    move_reader_init(&reader, chunk->begin, (size_t)(chunk->end - chunk->begin));
+    size_t center = (size_t)(chunk->rows - 1) * span + (size_t)(chunk->cols - 1);
+    size_t capacity = 0;
+    int row = 0;
+    int col = 0;
+    char move;
+    while (next_move(&reader, &move)) {
+        int next_row = row + (move == 'D') - (move == 'U');
+        int next_col = col + (move == 'R') - (move == 'L');
+        if (next_row < chunk->min_row) {
+            chunk->min_row = next_row;
+        } else if (next_row > chunk->max_row) {
+            chunk->max_row = next_row;
+        }
+        if (next_col < chunk->min_col) {
+            chunk->min_col = next_col;
+        } else if (next_col > chunk->max_col) {
+            chunk->max_col = next_col;
+        }
+        if (chunk->max_row - chunk->min_row >= chunk->rows ||
+            chunk->max_col - chunk->min_col >= chunk->cols) {
+            chunk->out_of_bounds = true;
+            break;
+        }
+
+        size_t blank_cell = center + (size_t)((ptrdiff_t)row * (ptrdiff_t)span + col);
+        size_t tile_cell = center + (size_t)((ptrdiff_t)next_row * (ptrdiff_t)span + next_col);
+        size_t blank_src = window[blank_cell] ? (size_t)window[blank_cell] - 1 : blank_cell;
+        size_t tile_src = window[tile_cell] ? (size_t)window[tile_cell] - 1 : tile_cell;
+        if (!track_cell(chunk, window, blank_cell, tile_src, &capacity) ||
+            !track_cell(chunk, window, tile_cell, blank_src, &capacity)) {
+            chunk->failed = true;
+            break;
+        }
+        row = next_row;
+        col = next_col;
+        chunk->moves++;
+    }
+    chunk->lines = reader.line;
+    chunk->end_row = row;
+    chunk->end_col = col;
+
+    if (!chunk->out_of_bounds && !chunk->failed) {
+        size_t count = chunk->touched_count ? chunk->touched_count : 1;
+        chunk->shifts = mem_alloc(MEM_REPLAY, sizeof(CellShift) * count);
+        if (!chunk->shifts) {
+            chunk->failed = true;
+        } else {
+            int row_offset = chunk->rows - 1;
+            int col_offset = chunk->cols - 1;
+            for (size_t i = 0; i < chunk->touched_count; i++) {
+                size_t cell = chunk->touched[i];
+                size_t src = (size_t)window[cell] - 1;
+                if (src == cell) {
+                    continue;
                 }
-                moves = new_moves;
+                chunk->shifts[chunk->shift_count++] = (CellShift){
+                    .row = (int32_t)(cell / span) - row_offset,
+                    .col = (int32_t)(cell % span) - col_offset,
+                    .src_row = (int32_t)(src / span) - row_offset,
+                    .src_col = (int32_t)(src % span) - col_offset
+                };
             }
-            moves[count++] = move;
         }
     }
-    fclose(file);
+    mem_free(chunk->touched);
+    chunk->touched = NULL;
+    mem_free(window);
+    trace_end("replay_chunk", traced, "moves", (long long)chunk->moves);
+    return NULL;
+}
 
-    if (count == 0) {
-        free(moves);
-        return false;
+static ReplayResult replay_chunk_serial(const ReplayChunk *chunk, int *state, int *pos,
+                                        int *blank_index, size_t *line_base, size_t *moves,
+                                        size_t *out_line) {
+    MoveReader reader;
+    move_reader_init(&reader, chunk->begin, (size_t)(chunk->end - chunk->begin));
+    char move;
+    while (next_move(&reader, &move)) {
+        if (!apply_move(state, pos, chunk->rows, chunk->cols, blank_index, move)) {
+            *out_line = *line_base + reader.line;
+            return REPLAY_INVALID;
+        }
+        (*moves)++;
     }
+    *line_base += reader.line;
+    return REPLAY_APPLIED;
+}
 
-    *out_moves = moves;
-    *out_count = count;
-    return true;
+static ReplayResult replay_moves_parallel(const MappedFile *file, int *state, int *pos,
+                                          int rows, int cols, int *blank_index,
+                                          int thread_count, size_t *out_line) {
+    ReplayChunk chunks[MAX_THREADS];
+    const char *begin = file->data;
+    const char *end = file->data + file->size;
+    const char *cursor = begin;
+    for (int i = 0; i < thread_count; i++) {
+        const char *stop = line_split(begin, end, cursor, i, thread_count);
+        chunks[i] = (ReplayChunk){.begin = cursor, .end = stop, .rows = rows, .cols = cols};
+        cursor = stop;
+    }
+    run_workers(chunks, sizeof(ReplayChunk), thread_count, replay_chunk_worker);
+
+    size_t max_shifts = 0;
+    for (int i = 0; i < thread_count; i++) {
+        if (chunks[i].shift_count > max_shifts) {
+            max_shifts = chunks[i].shift_count;
+        }
+    }
+    int *gathered = mem_alloc(MEM_REPLAY, sizeof(int) * (max_shifts ? max_shifts : 1));
+
+    ReplayResult result = REPLAY_APPLIED;
+    size_t line_base = 0;
+    size_t moves = 0;
+    for (int i = 0; i < thread_count && result == REPLAY_APPLIED; i++) {
+        ReplayChunk *chunk = &chunks[i];
+        int row = *blank_index / cols;
+        int col = *blank_index % cols;
+        bool fits = !chunk->out_of_bounds && !chunk->failed && gathered &&
+                    row + chunk->min_row >= 0 && row + chunk->max_row < rows &&
+                    col + chunk->min_col >= 0 && col + chunk->max_col < cols;
+        if (!fits) {
+            result = replay_chunk_serial(chunk, state, pos, blank_index, &line_base, &moves,
+                                         out_line);
+            continue;
+        }
+
+        for (size_t s = 0; s < chunk->shift_count; s++) {
+            const CellShift *shift = &chunk->shifts[s];
+            gathered[s] = state[(row + shift->src_row) * cols + col + shift->src_col];
+        }
+        for (size_t s = 0; s < chunk->shift_count; s++) {
+            const CellShift *shift = &chunk->shifts[s];
+            int cell = (row + shift->row) * cols + col + shift->col;
+            state[cell] = gathered[s];
+            if (gathered[s] != -1) {
+                pos[gathered[s]] = cell;
+            }
+        }
+        *blank_index = (row + chunk->end_row) * cols + col + chunk->end_col;
+        line_base += chunk->lines;
+        moves += chunk->moves;
+    }
+
+    for (int i = 0; i < thread_count; i++) {
+        mem_free(chunks[i].shifts);
+    }
+    mem_free(gathered);
+    if (result == REPLAY_APPLIED && moves == 0) {
+        return REPLAY_EMPTY;
+    }
+    return result;
+}
+
+static ReplayResult replay_moves(const char *path, int *state, int *pos, int rows, int cols,
+                                 int *blank_index, size_t *out_line) {
+    MappedFile file;
+    if (!map_file(path, &file)) {
+        return REPLAY_EMPTY;
+    }
+
+    int thread_count = hardware_threads();
+    if (thread_count > 1 && file.size >= PARALLEL_REPLAY_MIN_BYTES) {
+        ReplayResult result = replay_moves_parallel(&file, state, pos, rows, cols, blank_index,
+                                                    thread_count, out_line);
+        unmap_file(&file);
+        return result;
+    }
+
+    MoveReader reader;
+    move_reader_init(&reader, file.data, file.size);
+    ReplayResult result = REPLAY_EMPTY;
+    char move;
+    while (next_move(&reader, &move)) {
+        if (!apply_move(state, pos, rows, cols, blank_index, move)) {
+            *out_line = reader.line;
+            result = REPLAY_INVALID;
+            break;
+        }
+        result = REPLAY_APPLIED;
+    }
+
+    unmap_file(&file);
+    return result;
 }
 
 static void write_moves(const char *path, const char *moves, size_t count) {
-    FILE *file = fopen(path, "w");
-    if (!file) {
+    double traced = trace_begin();
+    OutputBuffer out;
+    if (!output_open(&out, path)) {
         fprintf(stderr, "Failed to write move file: %s\n", path);
         return;
     }
     for (size_t i = 0; i < count; i++) {
-        fprintf(file, "%c\n", moves[i]);
+        output_reserve(&out, 2);
+        out.data[out.used++] = moves[i];
+        out.data[out.used++] = '\n';
+    }
+    if (!output_close(&out)) {
+        fprintf(stderr, "Failed to write move file: %s\n", path);
     }
-    fclose(file);
+    trace_end("write_moves", traced, "moves", (long long)count);
 }
 
-static int count_inversions(const int *state, int len) {
-    int inv = 0;
-    for (int i = 0; i < len; i++) {
-        if (state[i] == -1) {
+static int inversion_parity(const int *state, int len, int blank_index) {
+    int count = len - 1;
+    uint64_t *visited = mem_calloc(MEM_PARITY, ((size_t)count + 63) / 64, sizeof(uint64_t));
+    if (!visited) {
+        fprintf(stderr, "Failed to allocate parity check.\n");
+        return -1;
+    }
+    int cycles = 0;
+    for (int start = 0; start < count; start++) {
+        if (visited[start / 64] & (1ULL << (start % 64))) {
             continue;
         }
-        for (int j = i + 1; j < len; j++) {
-            if (state[j] == -1) {
-                continue;
-            }
-            if (state[i] > state[j]) {
-                inv++;
-            }
+        cycles++;
+        int k = start;
+        while (!(visited[k / 64] & (1ULL << (k % 64)))) {
+            visited[k / 64] |= 1ULL << (k % 64);
+            k = state[k < blank_index ? k : k + 1];
         }
     }
-    return inv;
+    mem_free(visited);
+    return (count - cycles) % 2;
 }
 
-static bool is_solvable(const int *state, int n, int blank_index) {
-    int len = n * n;
-    int inversions = count_inversions(state, len);
-    if (n % 2 == 1) {
-        return (inversions % 2) == 0;
-    }
-    int blank_row_from_bottom = n - (blank_index / n);
-    if (blank_row_from_bottom % 2 == 0) {
-        return (inversions % 2) == 1;
+static bool parity_solvable(int parity, int rows, int cols, int blank_index) {
+    int trailing = (rows * cols - 1 - blank_index) & 1;
+    int distance = rows - 1 - blank_index / cols + cols - 1 - blank_index % cols;
+    return (parity ^ trailing) == (distance & 1);
+}
+
+/* Returns false when the parity check could not run; *solvable is set otherwise. */
+static bool is_solvable(const int *state, int rows, int cols, int blank_index, bool *solvable) {
+    int parity = inversion_parity(state, rows * cols, blank_index);
+    if (parity < 0) {
+        return false;
     }
-    return (inversions % 2) == 0;
+    *solvable = parity_solvable(parity, rows, cols, blank_index);
+    return true;
 }
 
-static void make_solvable(int *state, int n, int *blank_index) {
-    if (is_solvable(state, n, *blank_index)) {
-        return;
+static bool make_solvable(int *state, int rows, int cols, int *blank_index, int parity) {
+    int len = rows * cols;
+    if (parity < 0) {
+        parity = inversion_parity(state, len, *blank_index);
+        if (parity < 0) {
+            return false;
+        }
+    }
+    if (parity_solvable(parity, rows, cols, *blank_index)) {
+        return true;
     }
-    int len = n * n;
     int first = -1;
     int second = -1;
     for (int i = 0; i < len; i++) {
@@ -308,182 +1770,3632 @@ static void make_solvable(int *state, int n, int *blank_index) {
         state[first] = state[second];
         state[second] = temp;
     }
+    return true;
 }
 
-static bool generate_ini_file(const char *path, int n) {
-    if (n <= 1) {
-        fprintf(stderr, "Puzzle size must be greater than 1.\n");
-        return false;
+static void rng_seed(Rng *rng, uint64_t seed) {
+    for (int i = 0; i < 4; i++) {
+        rng->s[i] = mix64(seed + (uint64_t)i * 0x9E3779B97F4A7C15ULL);
     }
-    int len = n * n;
-    int *state = malloc(sizeof(int) * (size_t)len);
-    if (!state) {
-        fprintf(stderr, "Failed to allocate puzzle state.\n");
-        return false;
+}
+
+static inline uint64_t rotl64(uint64_t value, int shift) {
+    return (value << shift) | (value >> (64 - shift));
+}
+
+static inline uint64_t rng_next(Rng *rng) {
+    uint64_t *s = rng->s;
+    uint64_t result = rotl64(s[1] * 5, 7) * 9;
+    uint64_t t = s[1] << 17;
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = rotl64(s[3], 45);
+    return result;
+}
+
+static inline uint64_t rng_below(Rng *rng, uint64_t bound) {
+    unsigned __int128 product = (unsigned __int128)rng_next(rng) * bound;
+    uint64_t low = (uint64_t)product;
+    if (low < bound) {
+        uint64_t threshold = (0 - bound) % bound;
+        while (low < threshold) {
+            product = (unsigned __int128)rng_next(rng) * bound;
+            low = (uint64_t)product;
+        }
     }
+    return (uint64_t)(product >> 64);
+}
+
+static uint64_t default_seed(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    uint64_t entropy = (uint64_t)ts.tv_sec ^ ((uint64_t)ts.tv_nsec << 20);
+    return mix64(entropy ^ ((uint64_t)getpid() << 44));
+}
+
+static bool shuffle_state(int *state, int rows, int cols, Rng *rng, int *blank_index) {
+    int len = rows * cols;
     for (int i = 0; i < len - 1; i++) {
         state[i] = i;
     }
     state[len - 1] = -1;
 
-    srand((unsigned int)time(NULL));
+    int swaps = 0;
+    int blank = len - 1;
     for (int i = len - 1; i > 0; i--) {
-        int j = rand() % (i + 1);
+        int j = (int)rng_below(rng, (uint64_t)i + 1);
+        swaps ^= j != i;
         int temp = state[i];
         state[i] = state[j];
         state[j] = temp;
+        if (blank == i || blank == j) {
+            blank = blank == i ? j : i;
+        }
     }
 
-    int blank_index = 0;
-    for (int i = 0; i < len; i++) {
-        if (state[i] == -1) {
-            blank_index = i;
-            break;
+    *blank_index = blank;
+
+    return make_solvable(state, rows, cols, blank_index,
+                         swaps ^ ((len - 1 - *blank_index) & 1));
+}
+
+static void scramble_state(int *state, int rows, int cols, int depth, Rng *rng,
+                           int *blank_index) {
+    int len = rows * cols;
+    for (int i = 0; i < len - 1; i++) {
+        state[i] = i;
+    }
+    state[len - 1] = -1;
+    *blank_index = len - 1;
+
+    const char moves[4] = {'U', 'D', 'L', 'R'};
+    char prev_move = '\0';
+    for (int step = 0; step < depth; step++) {
+        int row = *blank_index / cols;
+        int col = *blank_index % cols;
+        bool allowed[4] = {row > 0, row < rows - 1, col > 0, col < cols - 1};
+        char candidates[4];
+        int count = 0;
+        for (int i = 0; i < 4; i++) {
+            if (allowed[i] && moves[i] != opposite_move(prev_move)) {
+                candidates[count++] = moves[i];
+            }
         }
+        prev_move = candidates[rng_below(rng, (uint64_t)count)];
+        apply_move(state, NULL, rows, cols, blank_index, prev_move);
     }
+}
 
-    make_solvable(state, n, &blank_index);
+static bool write_ini_file(const char *path, const int *state, int rows, int cols) {
+    OutputBuffer out;
+    if (!output_open(&out, path)) {
+        fprintf(stderr, "Failed to write %s: %s\n", path, strerror(errno));
+        return false;
+    }
 
-    FILE *file = fopen(path, "w");
-    if (!file) {
+    output_int(&out, rows);
+    if (cols != rows) {
+        output_char(&out, ',');
+        output_int(&out, cols);
+    }
+    output_char(&out, '\n');
+    output_state(&out, state, rows, cols);
+    if (!output_close(&out)) {
         fprintf(stderr, "Failed to write %s: %s\n", path, strerror(errno));
-        free(state);
         return false;
     }
+    return true;
+}
 
-    fprintf(file, "%d\n", n);
-    for (int r = 0; r < n; r++) {
-        for (int c = 0; c < n; c++) {
-            if (c > 0) {
-                fprintf(file, ",");
-            }
-            fprintf(file, "%d", state[r * n + c]);
-        }
-        fprintf(file, "\n");
+static bool generate_ini_file(const char *path, int rows, int cols, uint64_t seed) {
+    int *state = mem_alloc(MEM_BOARD, sizeof(int) * (size_t)rows * (size_t)cols);
+    if (!state) {
+        fprintf(stderr, "Failed to allocate puzzle state.\n");
+        return false;
     }
 
-    fclose(file);
-    free(state);
-    return true;
+    Rng rng;
+    rng_seed(&rng, seed);
+    int blank_index = 0;
+    bool written = shuffle_state(state, rows, cols, &rng, &blank_index) &&
+                   write_ini_file(path, state, rows, cols);
+    mem_free(state);
+    return written;
 }
 
-static int ida_search(SearchContext *ctx, int *state, int *blank_index, int g, int bound,
-                      char prev_move, char *path) {
-    int h = manhattan_distance(state, ctx->n);
-    int f = g + h;
-    if (f > bound) {
-        return f;
+static const uint32_t sha256_k[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4,
+    0xab1c5ed5, 0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe,
+    0x9bdc06a7, 0xc19bf174, 0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f,
+    0x4a7484aa, 0x5cb0a9dc, 0x76f988da, 0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7,
+    0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967, 0x27b70a85, 0x2e1b2138, 0x4d2c6dfc,
+    0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85, 0xa2bfe8a1, 0xa81a664b,
+    0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070, 0x19a4c116,
+    0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7,
+    0xc67178f2
+};
+
+static inline uint32_t rotr32(uint32_t value, int shift) {
+    return (value >> shift) | (value << (32 - shift));
+}
+
+static void sha256_block(Sha256 *sha, const unsigned char *block) {
+    uint32_t w[64];
+    for (int i = 0; i < 16; i++) {
+        w[i] = (uint32_t)block[i * 4] << 24 | (uint32_t)block[i * 4 + 1] << 16 |
+               (uint32_t)block[i * 4 + 2] << 8 | (uint32_t)block[i * 4 + 3];
     }
-    if (is_goal(state, ctx->len)) {
-        return -1;
+    for (int i = 16; i < 64; i++) {
+        uint32_t s0 = rotr32(w[i - 15], 7) ^ rotr32(w[i - 15], 18) ^ (w[i - 15] >> 3);
+        uint32_t s1 = rotr32(w[i - 2], 17) ^ rotr32(w[i - 2], 19) ^ (w[i - 2] >> 10);
+        w[i] = w[i - 16] + s0 + w[i - 7] + s1;
     }
 
-    ctx->expanded++;
+    uint32_t a = sha->h[0], b = sha->h[1], c = sha->h[2], d = sha->h[3];
+    uint32_t e = sha->h[4], f = sha->h[5], g = sha->h[6], h = sha->h[7];
+    for (int i = 0; i < 64; i++) {
+        uint32_t s1 = rotr32(e, 6) ^ rotr32(e, 11) ^ rotr32(e, 25);
+        uint32_t ch = (e & f) ^ (~e & g);
+        uint32_t t1 = h + s1 + ch + sha256_k[i] + w[i];
+        uint32_t s0 = rotr32(a, 2) ^ rotr32(a, 13) ^ rotr32(a, 22);
+        uint32_t maj = (a & b) ^ (a & c) ^ (b & c);
+        uint32_t t2 = s0 + maj;
+        h = g;
+        g = f;
+        f = e;
+        e = d + t1;
+        d = c;
+        c = b;
+        b = a;
+        a = t1 + t2;
+    }
+    sha->h[0] += a;
+    sha->h[1] += b;
+    sha->h[2] += c;
+    sha->h[3] += d;
+    sha->h[4] += e;
+    sha->h[5] += f;
+    sha->h[6] += g;
+    sha->h[7] += h;
+}
 
-    int min = INT_MAX;
-    const char moves[4] = {'U', 'D', 'L', 'R'};
-    for (int i = 0; i < 4; i++) {
-        char move = moves[i];
-        if (prev_move && move == opposite_move(prev_move)) {
-            continue;
+static void sha256_init(Sha256 *sha) {
+    static const uint32_t initial[8] = {
+        0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+        0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+    };
+    memcpy(sha->h, initial, sizeof(initial));
+    sha->length = 0;
+    sha->used = 0;
+}
+
+static void sha256_update(Sha256 *sha, const void *data, size_t size) {
+    const unsigned char *bytes = data;
+    sha->length += size;
+    while (size > 0) {
+        size_t take = 64 - sha->used;
+        if (take > size) {
+            take = size;
         }
-        int prior_blank = *blank_index;
-        if (!apply_move(state, ctx->n, blank_index, move)) {
-            continue;
+        memcpy(sha->block + sha->used, bytes, take);
+        sha->used += take;
+        bytes += take;
+        size -= take;
+        if (sha->used == 64) {
+            sha256_block(sha, sha->block);
+            sha->used = 0;
         }
+    }
+}
 
-        path[g] = move;
-        int result = ida_search(ctx, state, blank_index, g + 1, bound, move, path);
-        if (result == -1) {
+static void sha256_final(Sha256 *sha, unsigned char digest[32]) {
+    uint64_t bits = sha->length * 8;
+    unsigned char pad = 0x80;
+    sha256_update(sha, &pad, 1);
+    pad = 0;
+    while (sha->used != 56) {
+        sha256_update(sha, &pad, 1);
+    }
+    unsigned char length[8];
+    for (int i = 0; i < 8; i++) {
+        length[i] = (unsigned char)(bits >> (56 - 8 * i));
+    }
+    sha256_update(sha, length, sizeof(length));
+    for (int i = 0; i < 8; i++) {
+        digest[i * 4] = (unsigned char)(sha->h[i] >> 24);
+        digest[i * 4 + 1] = (unsigned char)(sha->h[i] >> 16);
+        digest[i * 4 + 2] = (unsigned char)(sha->h[i] >> 8);
+        digest[i * 4 + 3] = (unsigned char)sha->h[i];
+    }
+}
+
+static void board_digest(const int *state, int rows, int cols, char hex[65]) {
+    Sha256 sha;
+    sha256_init(&sha);
+    unsigned char word[4];
+    int len = rows * cols;
+    for (int i = rows == cols ? -1 : -2; i < len; i++) {
+        uint32_t value = (uint32_t)(i == -2 ? cols : i == -1 ? rows : state[i]);
+        word[0] = (unsigned char)value;
+        word[1] = (unsigned char)(value >> 8);
+        word[2] = (unsigned char)(value >> 16);
+        word[3] = (unsigned char)(value >> 24);
+        sha256_update(&sha, word, sizeof(word));
+    }
+    unsigned char digest[32];
+    sha256_final(&sha, digest);
+    for (int i = 0; i < 32; i++) {
+        hex[i * 2] = "0123456789abcdef"[digest[i] >> 4];
+        hex[i * 2 + 1] = "0123456789abcdef"[digest[i] & 15];
+    }
+    hex[64] = '\0';
+}
+
+static bool verify_solution(const int *state, int rows, int cols, int blank_index,
+                            const char *moves, size_t count) {
+    int len = rows * cols;
+    int *scratch = mem_alloc(MEM_CACHE, sizeof(int) * (size_t)len);
+    if (!scratch) {
+        return false;
+    }
+    memcpy(scratch, state, sizeof(int) * (size_t)len);
+    bool valid = true;
+    for (size_t i = 0; i < count && valid; i++) {
+        valid = apply_move(scratch, NULL, rows, cols, &blank_index, moves[i]);
+    }
+    valid = valid && is_goal(scratch, len);
+    mem_free(scratch);
+    return valid;
+}
+
+static bool load_cached_solution(const Options *options, const char *digest, const int *state,
+                                 int rows, int cols, int blank_index, char **out_moves,
+                                 size_t *out_count) {
+    char path[PATH_MAX];
+    snprintf(path, sizeof(path), "%s/%s%s", options->cache_dir, digest, CACHE_SUFFIX);
+    MappedFile file;
+    if (!map_file(path, &file)) {
+        return false;
+    }
+
+    char *moves = mem_alloc(MEM_CACHE, file.size ? file.size : 1);
+    bool valid = moves != NULL;
+    if (valid) {
+        if (file.size > 0) {
+            memcpy(moves, file.data, file.size);
+        }
+        valid = verify_solution(state, rows, cols, blank_index, moves, file.size);
+    }
+    size_t count = file.size;
+    unmap_file(&file);
+    if (!valid) {
+        if (moves) {
+            fprintf(stderr, "Discarding cache entry %s: it does not solve this board.\n", path);
+            unlink(path);
+        }
+        mem_free(moves);
+        return false;
+    }
+
+    utimensat(AT_FDCWD, path, NULL, 0);
+    *out_moves = moves;
+    *out_count = count;
+    return true;
+}
+
+static int compare_cache_entries(const void *lhs, const void *rhs) {
+    const CacheEntry *a = lhs;
+    const CacheEntry *b = rhs;
+    if (a->mtime.tv_sec != b->mtime.tv_sec) {
+        return a->mtime.tv_sec < b->mtime.tv_sec ? -1 : 1;
+    }
+    if (a->mtime.tv_nsec != b->mtime.tv_nsec) {
+        return a->mtime.tv_nsec < b->mtime.tv_nsec ? -1 : 1;
+    }
+    return strcmp(a->name, b->name);
+}
+
+static void evict_cache(const Options *options) {
+    DIR *dir = opendir(options->cache_dir);
+    if (!dir) {
+        return;
+    }
+
+    CacheEntry *entries = NULL;
+    size_t count = 0;
+    size_t capacity = 0;
+    unsigned long long total = 0;
+    size_t suffix_len = strlen(CACHE_SUFFIX);
+    struct dirent *item;
+    while ((item = readdir(dir)) != NULL) {
+        size_t name_len = strlen(item->d_name);
+        if (item->d_name[0] == '.' || name_len <= suffix_len ||
+            name_len >= sizeof(entries->name) ||
+            strcmp(item->d_name + name_len - suffix_len, CACHE_SUFFIX) != 0) {
+            continue;
+        }
+        struct stat st;
+        if (fstatat(dirfd(dir), item->d_name, &st, 0) != 0) {
+            continue;
+        }
+        if (count == capacity) {
+            capacity = capacity ? capacity * 2 : 64;
+            CacheEntry *grown = mem_realloc(MEM_CACHE, entries, sizeof(CacheEntry) * capacity);
+            if (!grown) {
+                break;
+            }
+            entries = grown;
+        }
+        entries[count].mtime = st.st_mtim;
+        entries[count].size = st.st_size;
+        memcpy(entries[count].name, item->d_name, name_len + 1);
+        total += (unsigned long long)st.st_size;
+        count++;
+    }
+
+    if (total > options->cache_limit) {
+        qsort(entries, count, sizeof(CacheEntry), compare_cache_entries);
+        for (size_t i = 0; i < count && total > options->cache_limit; i++) {
+            if (unlinkat(dirfd(dir), entries[i].name, 0) == 0 || errno == ENOENT) {
+                total -= (unsigned long long)entries[i].size;
+            }
+        }
+    }
+    closedir(dir);
+    mem_free(entries);
+}
+
+static void store_cached_solution(const Options *options, const char *digest, const char *moves,
+                                  size_t count) {
+    if (mkdir(options->cache_dir, 0755) != 0 && errno != EEXIST) {
+        fprintf(stderr, "Failed to create cache %s: %s\n", options->cache_dir, strerror(errno));
+        return;
+    }
+
+    char path[PATH_MAX];
+    char temp_path[PATH_MAX];
+    snprintf(path, sizeof(path), "%s/%s%s", options->cache_dir, digest, CACHE_SUFFIX);
+    snprintf(temp_path, sizeof(temp_path), "%s/.%s.%ld.tmp", options->cache_dir, digest,
+             (long)getpid());
+
+    OutputBuffer out;
+    if (!output_open(&out, temp_path)) {
+        fprintf(stderr, "Failed to write %s: %s\n", temp_path, strerror(errno));
+        return;
+    }
+    output_bytes(&out, moves, count);
+    output_flush(&out);
+    if (!out.failed && fsync(out.fd) != 0) {
+        out.failed = true;
+    }
+    if (!output_close(&out) || rename(temp_path, path) != 0) {
+        fprintf(stderr, "Failed to store cache entry %s: %s\n", path, strerror(errno));
+        unlink(temp_path);
+        return;
+    }
+    evict_cache(options);
+}
+
+static inline uint64_t cell_key(int len, int pos, int tile) {
+    int slot = tile < 0 ? len - 1 : tile;
+    return mix64((uint64_t)pos * (uint64_t)len + (uint64_t)slot);
+}
+
+static uint64_t board_key(const int *state, int len) {
+    uint64_t key = 0;
+    for (int i = 0; i < len; i++) {
+        key ^= cell_key(len, i, state[i]);
+    }
+    return key;
+}
+
+static bool table_init(TranspositionTable *table, int bits) {
+    size_t count = (size_t)1 << bits;
+    table->entries = mem_calloc(MEM_TABLE, count, sizeof(TableEntry));
+    table->mask = count - 1;
+    return table->entries != NULL;
+}
+
+static bool table_load(TranspositionTable *table, const char *path, int rows, int cols) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    TableHeader header;
+    struct stat st;
+    bool valid = fstat(fd, &st) == 0 && read(fd, &header, sizeof(header)) == sizeof(header);
+    if (valid) {
+        valid = memcmp(header.magic, TABLE_MAGIC, sizeof(header.magic)) == 0 &&
+                header.bits > 0 && header.bits < 40 &&
+                (size_t)st.st_size == sizeof(header) + (sizeof(TableEntry) << header.bits);
+    }
+    if (!valid) {
+        fprintf(stderr, "Ignoring transposition table %s: unreadable or corrupt.\n", path);
+        close(fd);
+        return false;
+    }
+    if (header.rows != (uint32_t)rows || header.cols != (uint32_t)cols ||
+        header.heuristic_version != HEURISTIC_VERSION) {
+        printf("Ignoring transposition table %s: built for %ux%u with heuristic v%u.\n", path,
+               header.rows, header.cols, header.heuristic_version);
+        close(fd);
+        return false;
+    }
+
+    void *map = mmap(NULL, (size_t)st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        fprintf(stderr, "Failed to map %s: %s\n", path, strerror(errno));
+        return false;
+    }
+    table->mapping = map;
+    table->mapping_size = (size_t)st.st_size;
+    mem_account(MEM_TABLE, (long long)table->mapping_size);
+    table->entries = (TableEntry *)((char *)map + sizeof(header));
+    table->mask = ((size_t)1 << header.bits) - 1;
+    table->preloaded = header.used;
+    printf("Loaded transposition table %s: %llu entries.\n", path,
+           (unsigned long long)header.used);
+    return true;
+}
+
+static void table_free(TranspositionTable *table) {
+    if (table->mapping) {
+        munmap(table->mapping, table->mapping_size);
+        mem_account(MEM_TABLE, -(long long)table->mapping_size);
+    } else {
+        mem_free(table->entries);
+    }
+    table->entries = NULL;
+    table->mapping = NULL;
+}
+
+static inline int table_probe(TranspositionTable *table, uint64_t key) {
+    TableEntry *entry = &table->entries[key & table->mask];
+    table->probes++;
+    if (entry->key != key) {
+        return -1;
+    }
+    table->hits++;
+    if (entry->flags & TABLE_PRELOADED) {
+        table->preloaded_hits++;
+        if (!(entry->flags & TABLE_USED)) {
+            entry->flags |= TABLE_USED;
+            table->preloaded_used++;
+        }
+    }
+    return entry->h;
+}
+
+static inline void table_store(TranspositionTable *table, uint64_t key, int h) {
+    TableEntry *entry = &table->entries[key & table->mask];
+    if (entry->key == key && entry->h >= h) {
+        return;
+    }
+    entry->key = key;
+    entry->h = h;
+    entry->flags = 0;
+}
+
+static bool table_save(const TranspositionTable *table, int rows, int cols) {
+    char temp_path[PATH_MAX];
+    snprintf(temp_path, sizeof(temp_path), "%s.tmp", table->path);
+    OutputBuffer out;
+    if (!output_open(&out, temp_path)) {
+        fprintf(stderr, "Failed to write %s: %s\n", temp_path, strerror(errno));
+        return false;
+    }
+
+    size_t count = table->mask + 1;
+    TableHeader header = {
+        .rows = (uint32_t)rows,
+        .cols = (uint32_t)cols,
+        .heuristic_version = HEURISTIC_VERSION
+    };
+    memcpy(header.magic, TABLE_MAGIC, sizeof(header.magic));
+    while (((size_t)1 << header.bits) < count) {
+        header.bits++;
+    }
+    for (size_t i = 0; i < count; i++) {
+        header.used += table->entries[i].key != 0;
+    }
+    output_bytes(&out, &header, sizeof(header));
+    for (size_t i = 0; i < count; i++) {
+        TableEntry entry = table->entries[i];
+        entry.flags = entry.key ? TABLE_PRELOADED : 0;
+        output_bytes(&out, &entry, sizeof(entry));
+    }
+    if (!output_close(&out) || rename(temp_path, table->path) != 0) {
+        fprintf(stderr, "Failed to save transposition table %s: %s\n", table->path,
+                strerror(errno));
+        unlink(temp_path);
+        return false;
+    }
+    return true;
+}
+
+static void table_report(const TranspositionTable *table) {
+    double hit_rate = table->probes ? 100.0 * (double)table->hits / (double)table->probes : 0.0;
+    printf("Transposition table: %llu probes, %llu hits (%.1f%%), %llu from preloaded "
+           "entries.\n", table->probes, table->hits, hit_rate, table->preloaded_hits);
+    if (table->preloaded > 0) {
+        printf("Preloaded entries used: %llu of %llu (%.1f%%).\n",
+               (unsigned long long)table->preloaded_used,
+               (unsigned long long)table->preloaded,
+               100.0 * (double)table->preloaded_used / (double)table->preloaded);
+    }
+}
+
+static volatile sig_atomic_t checkpoint_signal = 0;
+
+static void request_checkpoint(int signo) {
+    checkpoint_signal = signo;
+}
+
+static bool write_checkpoint(const SearchContext *ctx, int depth, int bound, const char *path) {
+    char temp_path[PATH_MAX];
+    snprintf(temp_path, sizeof(temp_path), "%s.tmp", ctx->checkpoint_path);
+
+    OutputBuffer out;
+    if (!output_open(&out, temp_path)) {
+        fprintf(stderr, "Failed to write %s: %s\n", temp_path, strerror(errno));
+        return false;
+    }
+    CheckpointHeader header = {
+        .state_hash = ctx->state_hash,
+        .expanded = ctx->expanded,
+        .rows = ctx->rows,
+        .cols = ctx->cols,
+        .bound = bound,
+        .depth = depth
+    };
+    memcpy(header.magic, CHECKPOINT_MAGIC, sizeof(header.magic));
+    output_bytes(&out, &header, sizeof(header));
+    output_bytes(&out, path, (size_t)depth);
+    output_bytes(&out, ctx->child, (size_t)depth);
+    output_bytes(&out, ctx->level_min, sizeof(int) * (size_t)depth);
+    output_flush(&out);
+    if (!out.failed && fsync(out.fd) != 0) {
+        out.failed = true;
+    }
+    if (!output_close(&out) || rename(temp_path, ctx->checkpoint_path) != 0) {
+        fprintf(stderr, "Failed to write checkpoint %s: %s\n", ctx->checkpoint_path,
+                strerror(errno));
+        unlink(temp_path);
+        return false;
+    }
+    return true;
+}
+
+static bool load_checkpoint(SearchContext *ctx, char *path, int *bound) {
+    MappedFile file;
+    if (!map_file(ctx->checkpoint_path, &file)) {
+        return false;
+    }
+
+    CheckpointHeader header;
+    bool valid = file.size >= sizeof(header);
+    if (valid) {
+        memcpy(&header, file.data, sizeof(header));
+        valid = memcmp(header.magic, CHECKPOINT_MAGIC, sizeof(header.magic)) == 0 &&
+                header.depth >= 0 && header.depth <= header.bound &&
+                header.bound <= MAX_ITERATION_BOUND &&
+                file.size == sizeof(header) + (size_t)header.depth * (2 + sizeof(int));
+    }
+    if (!valid) {
+        fprintf(stderr, "Ignoring checkpoint %s: unreadable or corrupt.\n",
+                ctx->checkpoint_path);
+        unmap_file(&file);
+        return false;
+    }
+    if (header.rows != ctx->rows || header.cols != ctx->cols ||
+        header.state_hash != ctx->state_hash) {
+        printf("Ignoring checkpoint %s: it belongs to a different board.\n",
+               ctx->checkpoint_path);
+        unmap_file(&file);
+        return false;
+    }
+
+    size_t depth = (size_t)header.depth;
+    const char *payload = file.data + sizeof(header);
+    memcpy(path, payload, depth);
+    memcpy(ctx->child, payload + depth, depth);
+    memcpy(ctx->level_min, payload + 2 * depth, sizeof(int) * depth);
+    ctx->expanded = header.expanded;
+    ctx->resume_depth = header.depth;
+    *bound = header.bound;
+    unmap_file(&file);
+
+    printf("Resuming from checkpoint %s at bound %d, depth %d, %lld states expanded.\n",
+           ctx->checkpoint_path, header.bound, header.depth, ctx->expanded);
+    return true;
+}
+
+static bool poll_checkpoint(SearchContext *ctx, int depth, int bound, const char *path) {
+    bool interrupted = checkpoint_signal != 0;
+    double now = monotonic_seconds();
+    if (!interrupted && now < ctx->next_checkpoint) {
+        return true;
+    }
+    write_checkpoint(ctx, depth, bound, path);
+    if (ctx->table) {
+        table_save(ctx->table, ctx->rows, ctx->cols);
+    }
+    ctx->next_checkpoint = now + ctx->checkpoint_interval;
+    return !interrupted;
+}
+
+static void *progress_worker(void *arg) {
+    Progress *progress = arg;
+    long long last_expanded = 0;
+    double last_time = progress->started;
+    pthread_mutex_lock(&progress->lock);
+    while (!progress->done) {
+        double wake_at = monotonic_seconds() + progress->interval;
+        struct timespec deadline = {
+            .tv_sec = (time_t)wake_at,
+            .tv_nsec = (long)((wake_at - (double)(time_t)wake_at) * 1e9)
+        };
+        while (!progress->done &&
+               pthread_cond_timedwait(&progress->wake, &progress->lock, &deadline) != ETIMEDOUT) {
+        }
+        if (progress->done) {
+            break;
+        }
+
+        double now = monotonic_seconds();
+        long long expanded = atomic_load_explicit(&progress->expanded, memory_order_relaxed);
+        long long start = atomic_load_explicit(&progress->iteration_start, memory_order_relaxed);
+        long long previous = atomic_load_explicit(&progress->previous, memory_order_relaxed);
+        long long before = atomic_load_explicit(&progress->before_previous, memory_order_relaxed);
+        int bound = atomic_load_explicit(&progress->bound, memory_order_relaxed);
+        double rate = now > last_time ? (double)(expanded - last_expanded) / (now - last_time)
+                                      : 0.0;
+        last_expanded = expanded;
+        last_time = now;
+
+        long long done = expanded > start ? expanded - start : 0;
+        fprintf(stderr, "[%.1fs] bound %d: %lld nodes, %.0f nodes/s, iteration %lld", now -
+                progress->started, bound, expanded, rate, done);
+        if (previous > 0 && before > 0) {
+            double expected = (double)previous * ((double)previous / (double)before);
+            double remaining = expected > (double)done ? expected - (double)done : 0.0;
+            fprintf(stderr, " of ~%.0f", expected);
+            if (rate > 0.0) {
+                fprintf(stderr, ", ETA %.1fs", remaining / rate);
+            }
+        }
+        fputc('\n', stderr);
+    }
+    pthread_mutex_unlock(&progress->lock);
+    return NULL;
+}
+
+static bool progress_start(Progress *progress, pthread_t *thread, double interval) {
+    atomic_init(&progress->expanded, 0);
+    atomic_init(&progress->iteration_start, 0);
+    atomic_init(&progress->previous, 0);
+    atomic_init(&progress->before_previous, 0);
+    atomic_init(&progress->bound, 0);
+    progress->done = false;
+    progress->interval = interval;
+    progress->started = monotonic_seconds();
+    pthread_mutex_init(&progress->lock, NULL);
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&progress->wake, &attr);
+    pthread_condattr_destroy(&attr);
+    if (pthread_create(thread, NULL, progress_worker, progress) != 0) {
+        pthread_mutex_destroy(&progress->lock);
+        pthread_cond_destroy(&progress->wake);
+        return false;
+    }
+    return true;
+}
+
+static void progress_iteration(Progress *progress, int bound, long long expanded,
+                               long long last_iteration) {
+    atomic_store_explicit(&progress->before_previous,
+                          atomic_load_explicit(&progress->previous, memory_order_relaxed),
+                          memory_order_relaxed);
+    atomic_store_explicit(&progress->previous, last_iteration, memory_order_relaxed);
+    atomic_store_explicit(&progress->iteration_start, expanded, memory_order_relaxed);
+    atomic_store_explicit(&progress->expanded, expanded, memory_order_relaxed);
+    atomic_store_explicit(&progress->bound, bound, memory_order_relaxed);
+}
+
+static void progress_stop(Progress *progress, pthread_t thread) {
+    pthread_mutex_lock(&progress->lock);
+    progress->done = true;
+    pthread_cond_signal(&progress->wake);
+    pthread_mutex_unlock(&progress->lock);
+    pthread_join(thread, NULL);
+    pthread_mutex_destroy(&progress->lock);
+    pthread_cond_destroy(&progress->wake);
+}
+
+static int ida_search(SearchContext *ctx, int *state, int *blank_index, int g, int bound,
+                      char prev_move, char *path, int parent_h) {
+    int h = (int)manhattan_distance(state, ctx->rows, ctx->cols);
+    if (ctx->table) {
+        int learned = table_probe(ctx->table, ctx->key);
+        if (learned > h) {
+            h = learned;
+        }
+    }
+
+    int min = INT_MAX;
+    int first = 0;
+    if (g < ctx->resume_depth) {
+        min = ctx->level_min[g];
+        first = ctx->child[g];
+    } else {
+        ctx->resume_depth = 0;
+        if (ctx->checkpoint_path && (++ctx->visits & CHECKPOINT_POLL_MASK) == 0 &&
+            !poll_checkpoint(ctx, g, bound, path)) {
+            return SEARCH_ABORTED;
+        }
+
+        int f = g + h;
+        if (f > bound) {
+            return f;
+        }
+        if (is_goal(state, ctx->len)) {
             return -1;
         }
-        if (result < min) {
-            min = result;
+
+        ctx->expanded++;
+        COUNT_DEPTH(g);
+        if ((ctx->expanded & PROGRESS_PUBLISH_MASK) == 0) {
+            if (ctx->progress) {
+                atomic_store_explicit(&ctx->progress->expanded, ctx->expanded,
+                                      memory_order_relaxed);
+            }
+            if (ctx->deadline > 0.0 && monotonic_seconds() > ctx->deadline) {
+                return SEARCH_ABORTED;
+            }
+        }
+    }
+
+    const char moves[4] = {'U', 'D', 'L', 'R'};
+    for (int i = first; i < 4; i++) {
+        char move = moves[i];
+        if (prev_move && move == opposite_move(prev_move)) {
+            COUNT(COUNTER_REVERSE_PRUNED);
+            continue;
+        }
+        int prior_blank = *blank_index;
+        if (!apply_move(state, ctx->pos, ctx->rows, ctx->cols, blank_index, move)) {
+            COUNT(COUNTER_MOVE_REJECTED);
+            continue;
+        }
+        /* Counted here rather than in apply_move so the undo below is not a second move. */
+        COUNT(COUNTER_MOVE_APPLIED);
+        ctx->generated++;
+        uint64_t key_delta = 0;
+        if (ctx->table) {
+            int tile = state[prior_blank];
+            key_delta = cell_key(ctx->len, prior_blank, tile) ^
+                        cell_key(ctx->len, *blank_index, tile) ^
+                        cell_key(ctx->len, prior_blank, -1) ^
+                        cell_key(ctx->len, *blank_index, -1);
+            ctx->key ^= key_delta;
+        }
+
+        path[g] = move;
+        if (ctx->child) {
+            ctx->child[g] = (unsigned char)i;
+            ctx->level_min[g] = min;
+        }
+        int result = ida_search(ctx, state, blank_index, g + 1, bound, move, path, h);
+        if (result == -1 || result == SEARCH_ABORTED) {
+            return result;
+        }
+        if (result < min) {
+            min = result;
+        }
+
+        ctx->key ^= key_delta;
+        apply_move(state, ctx->pos, ctx->rows, ctx->cols, blank_index, opposite_move(move));
+        *blank_index = prior_blank;
+    }
+
+    if (ctx->table && min != INT_MAX) {
+        int learned = min - g;
+        if (parent_h >= 0 && parent_h + 1 < learned) {
+            learned = parent_h + 1;
+        }
+        if (learned > h) {
+            table_store(ctx->table, ctx->key, learned);
+        }
+    }
+    return min;
+}
+
+static double branching_factor(const IterationStats *iterations, size_t index) {
+    if (index == 0 || iterations[index - 1].expanded == 0) {
+        return 0.0;
+    }
+    return (double)iterations[index].expanded / (double)iterations[index - 1].expanded;
+}
+
+static void report_iterations(const char *target, const IterationStats *iterations,
+                              size_t count) {
+    if (strcmp(target, "table") == 0) {
+        printf("%6s %6s %14s %14s %10s %8s\n", "bound", "next", "expanded", "generated",
+               "seconds", "ebf");
+        for (size_t i = 0; i < count; i++) {
+            const IterationStats *it = &iterations[i];
+            printf("%6d %6d %14lld %14lld %10.4f ", it->bound, it->next_bound, it->expanded,
+                   it->generated, it->seconds);
+            if (i == 0) {
+                printf("%8s\n", "-");
+            } else {
+                printf("%8.3f\n", branching_factor(iterations, i));
+            }
+        }
+        return;
+    }
+
+    OutputBuffer out;
+    if (!output_open(&out, target)) {
+        fprintf(stderr, "Failed to write %s: %s\n", target, strerror(errno));
+        return;
+    }
+    output_bytes(&out, "[\n", 2);
+    for (size_t i = 0; i < count; i++) {
+        const IterationStats *it = &iterations[i];
+        output_format(&out, "  {\"bound\": %d, \"next_bound\": %d, \"expanded\": %lld, "
+                            "\"generated\": %lld, \"seconds\": %.6f, ",
+                      it->bound, it->next_bound, it->expanded, it->generated, it->seconds);
+        if (i == 0 || iterations[i - 1].expanded == 0) {
+            output_format(&out, "\"branching_factor\": null}%s\n", i + 1 < count ? "," : "");
+        } else {
+            output_format(&out, "\"branching_factor\": %.4f}%s\n",
+                          branching_factor(iterations, i), i + 1 < count ? "," : "");
+        }
+    }
+    output_bytes(&out, "]\n", 2);
+    if (!output_close(&out)) {
+        fprintf(stderr, "Failed to write %s: %s\n", target, strerror(errno));
+    }
+}
+
+static void solve_puzzle(int *state, int *pos, int rows, int cols, int blank_index,
+                         const Options *options, SolveStats *stats) {
+    *stats = (SolveStats){0};
+    SearchContext ctx = {
+        .pos = pos,
+        .rows = rows,
+        .cols = cols,
+        .len = rows * cols,
+        .expanded = 0,
+        .checkpoint_path = options->checkpoint_path,
+        .checkpoint_interval = options->checkpoint_interval
+    };
+
+    char digest[65];
+    if (options->cache_dir) {
+        double traced = trace_begin();
+        board_digest(state, rows, cols, digest);
+        char *cached = NULL;
+        size_t cached_count = 0;
+        if (load_cached_solution(options, digest, state, rows, cols, blank_index, &cached,
+                                 &cached_count)) {
+            if (!options->quiet) {
+                printf("Shortest solution length: %zu moves (from cache)\n", cached_count);
+            }
+            write_moves(options->moves_path, cached, cached_count);
+            mem_free(cached);
+            *stats = (SolveStats){.solved = true, .length = cached_count};
+            trace_end("cache_lookup", traced, NULL, 0);
+            return;
+        }
+        trace_end("cache_lookup", traced, NULL, 0);
+    }
+
+    long long initial_bound = manhattan_distance(state, rows, cols);
+    if (initial_bound > MAX_ITERATION_BOUND) {
+        if (!options->quiet) {
+            printf("Search bound exceeded %d. No solution found.\n", MAX_ITERATION_BOUND);
+        }
+        return;
+    }
+    int bound = (int)initial_bound;
+    char *path = mem_alloc(MEM_SEARCH, sizeof(char) * (size_t)MAX_ITERATION_BOUND);
+    /* Only checkpoints need the per-depth resume state; plain searches skip it. */
+    if (ctx.checkpoint_path) {
+        ctx.child = mem_alloc(MEM_SEARCH, sizeof(unsigned char) * (size_t)MAX_ITERATION_BOUND);
+        ctx.level_min = mem_alloc(MEM_SEARCH, sizeof(int) * (size_t)MAX_ITERATION_BOUND);
+    }
+    if (!path || (ctx.checkpoint_path && (!ctx.child || !ctx.level_min))) {
+        fprintf(stderr, "Failed to allocate solution path.\n");
+        mem_free(path);
+        mem_free(ctx.child);
+        mem_free(ctx.level_min);
+        return;
+    }
+
+    TranspositionTable table = {.path = options->table_path};
+    if (options->table_path) {
+        double traced = trace_begin();
+        bool loaded = table_load(&table, options->table_path, rows, cols);
+        trace_end("table_load", traced, NULL, 0);
+        if (!loaded &&
+            !table_init(&table, options->table_bits)) {
+            fprintf(stderr, "Failed to allocate transposition table.\n");
+            mem_free(path);
+            mem_free(ctx.child);
+            mem_free(ctx.level_min);
+            return;
+        }
+        ctx.table = &table;
+        ctx.key = board_key(state, ctx.len);
+    }
+
+    if (ctx.checkpoint_path) {
+        ctx.state_hash = hash_state(state, ctx.len);
+        load_checkpoint(&ctx, path, &bound);
+        ctx.next_checkpoint = monotonic_seconds() + ctx.checkpoint_interval;
+        struct sigaction action = {.sa_handler = request_checkpoint};
+        sigemptyset(&action.sa_mask);
+        sigaction(SIGINT, &action, NULL);
+        sigaction(SIGTERM, &action, NULL);
+    }
+
+    Progress progress;
+    pthread_t progress_thread;
+    if (options->progress_interval > 0.0 &&
+        progress_start(&progress, &progress_thread, options->progress_interval)) {
+        ctx.progress = &progress;
+    }
+
+    if (options->search_seconds > 0.0) {
+        ctx.deadline = monotonic_seconds() + options->search_seconds;
+    }
+
+    IterationStats *iterations = NULL;
+    size_t iteration_count = 0;
+    size_t iteration_capacity = 0;
+    long long last_iteration = 0;
+    bool finished = true;
+    while (true) {
+        if (bound > MAX_ITERATION_BOUND) {
+            if (!options->quiet) {
+                printf("Search bound exceeded %d. No solution found.\n", MAX_ITERATION_BOUND);
+            }
+            break;
+        }
+        long long expanded_before = ctx.expanded;
+        long long generated_before = ctx.generated;
+        double started = monotonic_seconds();
+        if (ctx.progress) {
+            progress_iteration(ctx.progress, bound, ctx.expanded, last_iteration);
+        }
+        double traced = trace_begin();
+        int result = ida_search(&ctx, state, &blank_index, 0, bound, '\0', path, -1);
+        trace_end("iteration", traced, "bound", bound);
+        last_iteration = ctx.expanded - expanded_before;
+        if (options->iterations_path) {
+            if (iteration_count == iteration_capacity) {
+                size_t capacity = iteration_capacity ? iteration_capacity * 2 : 16;
+                IterationStats *grown = mem_realloc(MEM_SEARCH, iterations,
+                                                    sizeof(IterationStats) * capacity);
+                if (grown) {
+                    iterations = grown;
+                    iteration_capacity = capacity;
+                }
+            }
+            if (iteration_count < iteration_capacity) {
+                iterations[iteration_count++] = (IterationStats){
+                    .bound = bound,
+                    .next_bound = result >= 0 && result != INT_MAX ? result : -1,
+                    .expanded = ctx.expanded - expanded_before,
+                    .generated = ctx.generated - generated_before,
+                    .seconds = monotonic_seconds() - started
+                };
+            }
+        }
+        if (result == SEARCH_ABORTED && checkpoint_signal != 0) {
+            printf("Search interrupted; checkpoint saved to %s.\n", ctx.checkpoint_path);
+            stats->interrupted = (int)checkpoint_signal;
+            finished = false;
+            break;
+        }
+        if (result == SEARCH_ABORTED) {
+            if (!options->quiet) {
+                printf("IDA* did not finish within %.1f seconds.\n", options->search_seconds);
+            }
+            break;
+        }
+        if (result == -1) {
+            stats->solved = true;
+            stats->length = (unsigned long long)bound;
+            if (!options->quiet) {
+                printf("Shortest solution length: %d moves\n", bound);
+                printf("Tiles out of place: %d\n", count_misplaced(state, ctx.len));
+            }
+            write_moves(options->moves_path, path, (size_t)bound);
+            if (options->cache_dir) {
+                store_cached_solution(options, digest, path, (size_t)bound);
+            }
+            break;
+        }
+        if (result == INT_MAX) {
+            if (!options->quiet) {
+                printf("No solution found.\n");
+            }
+            break;
+        }
+        bound = result;
+    }
+
+    if (ctx.progress) {
+        progress_stop(ctx.progress, progress_thread);
+    }
+    if (finished && ctx.checkpoint_path) {
+        unlink(ctx.checkpoint_path);
+    }
+    stats->expanded = ctx.expanded;
+    if (!options->quiet) {
+        printf("States expanded: %lld\n", ctx.expanded);
+    }
+    if (options->iterations_path) {
+        report_iterations(options->iterations_path, iterations, iteration_count);
+        mem_free(iterations);
+    }
+    if (ctx.table) {
+        if (!options->quiet) {
+            table_report(&table);
+        }
+        table_save(&table, rows, cols);
+        table_free(&table);
+    }
+    mem_free(path);
+    mem_free(ctx.child);
+    mem_free(ctx.level_min);
+}
+
+static double estimate_probe(const int *initial, int *state, int rows, int cols, int blank_index,
+                             int bound, Rng *rng, int *next_bound, bool *goal,
+                             long long *visited) {
+    int len = rows * cols;
+    memcpy(state, initial, sizeof(int) * (size_t)len);
+    const char moves[4] = {'U', 'D', 'L', 'R'};
+    char prev_move = '\0';
+    double weight = 1.0;
+    double total = 0.0;
+    for (int g = 0;; g++) {
+        if (is_goal(state, len)) {
+            *goal = true;
+            break;
+        }
+        total += weight;
+        (*visited)++;
+
+        char children[4];
+        int count = 0;
+        for (int i = 0; i < 4; i++) {
+            if (prev_move && moves[i] == opposite_move(prev_move)) {
+                continue;
+            }
+            int prior_blank = blank_index;
+            if (!apply_move(state, NULL, rows, cols, &blank_index, moves[i])) {
+                continue;
+            }
+            int f = g + 1 + (int)manhattan_distance(state, rows, cols);
+            apply_move(state, NULL, rows, cols, &blank_index, opposite_move(moves[i]));
+            blank_index = prior_blank;
+            if (f <= bound) {
+                children[count++] = moves[i];
+            } else if (f < *next_bound) {
+                *next_bound = f;
+            }
+        }
+        if (count == 0) {
+            break;
+        }
+        weight *= count;
+        prev_move = children[rng_below(rng, (uint64_t)count)];
+        apply_move(state, NULL, rows, cols, &blank_index, prev_move);
+    }
+    return total;
+}
+
+/*
+ * Runs one real IDA* iteration at bound within the remaining search budget. Returns the next
+ * bound, -1 when the goal was reached, or SEARCH_ABORTED when the budget ran out.
+ */
+static int estimate_search(const int *initial, int *state, int *pos, int rows, int cols,
+                           int blank_index, int bound, double deadline, long long *expanded) {
+    int len = rows * cols;
+    memcpy(state, initial, sizeof(int) * (size_t)len);
+    for (int i = 0; i < len; i++) {
+        pos[tile_slot(state[i], len)] = i;
+    }
+    SearchContext ctx = {.pos = pos, .rows = rows, .cols = cols, .len = len,
+                         .deadline = deadline};
+    char *path = mem_alloc(MEM_SEARCH, sizeof(char) * (size_t)MAX_ITERATION_BOUND);
+    int result = SEARCH_ABORTED;
+    if (path) {
+        result = ida_search(&ctx, state, &blank_index, 0, bound, '\0', path, -1);
+    }
+    *expanded = ctx.expanded;
+    mem_free(path);
+    return result;
+}
+
+static bool run_estimate(const int *initial, int rows, int cols, int blank_index, int probes,
+                         const Options *options) {
+    int len = rows * cols;
+    if (len > ESTIMATE_MAX_CELLS) {
+        fprintf(stderr, "Estimates need a board of at most %d cells.\n", ESTIMATE_MAX_CELLS);
+        return false;
+    }
+    int *state = mem_alloc(MEM_SEARCH, sizeof(int) * (size_t)len);
+    int *pos = mem_alloc(MEM_SEARCH, sizeof(int) * (size_t)len);
+    if (!state || !pos) {
+        fprintf(stderr, "Failed to allocate puzzle state.\n");
+        mem_free(state);
+        mem_free(pos);
+        return false;
+    }
+
+    Rng rng;
+    rng_seed(&rng, options->has_seed ? options->seed : 1);
+    BoundEstimate estimates[ESTIMATE_MAX_BOUNDS];
+    int count = 0;
+    int bound = (int)manhattan_distance(initial, rows, cols);
+    long long visited = 0;
+    double started = monotonic_seconds();
+    double searching = 0.0;
+    double searched_before = 0.0;
+    double search_nodes = 0.0;
+    bool can_search = true;
+    double total_nodes = 0.0;
+    bool out_of_time = false;
+    while (count < ESTIMATE_MAX_BOUNDS && !out_of_time) {
+        BoundEstimate *estimate = &estimates[count++];
+        *estimate = (BoundEstimate){.bound = bound, .next_bound = INT_MAX, .searched = -1};
+        double sum = 0.0;
+        double sum_squares = 0.0;
+        int done = 0;
+        while (done < probes) {
+            double nodes = estimate_probe(initial, state, rows, cols, blank_index, bound, &rng,
+                                          &estimate->next_bound, &estimate->goal, &visited);
+            sum += nodes;
+            sum_squares += nodes * nodes;
+            done++;
+            if ((done & 63) == 0 && monotonic_seconds() - started > ESTIMATE_BUDGET_SECONDS) {
+                out_of_time = true;
+                break;
+            }
+        }
+        estimate->probes = done;
+        estimate->nodes = sum / done;
+        double variance = sum_squares / done - estimate->nodes * estimate->nodes;
+        estimate->error = done > 1 && variance > 0.0 ? sqrt(variance / (done - 1)) : 0.0;
+        total_nodes += estimate->nodes;
+        double probe_rate = (double)visited / (monotonic_seconds() - started - searching);
+
+        /* Probes rarely hit the goal of deep boards, so run the bound for real while it is cheap. */
+        double search_rate = searching > 0.0 && search_nodes > 0.0 ? search_nodes / searching
+                                                                  : probe_rate;
+        /* Searches share the one-second budget with the probes, so the whole run stays under it. */
+        double search_started = monotonic_seconds();
+        double search_deadline = fmin(search_started + ESTIMATE_SEARCH_SECONDS - searching,
+                                      started + ESTIMATE_BUDGET_SECONDS);
+        if (can_search && !estimate->goal &&
+            estimate->nodes / search_rate <= search_deadline - search_started) {
+            int result = estimate_search(initial, state, pos, rows, cols, blank_index, bound,
+                                         search_deadline, &estimate->searched);
+            searching += monotonic_seconds() - search_started;
+            /* An aborted search still expanded nodes in the time it took, so both count. */
+            search_nodes += (double)estimate->searched;
+            if (result == SEARCH_ABORTED) {
+                estimate->searched = -1;
+                can_search = false;
+            } else {
+                searched_before += (double)estimate->searched;
+                estimate->solved = result == -1;
+                estimate->goal = estimate->solved;
+                estimate->next_bound = result == -1 ? INT_MAX : result;
+            }
+        } else {
+            can_search = false;
+        }
+        double horizon_nodes = ESTIMATE_HORIZON_SECONDS * probe_rate;
+        if (estimate->goal || estimate->next_bound == INT_MAX || total_nodes > horizon_nodes) {
+            break;
+        }
+        bound = estimate->next_bound;
+    }
+    double elapsed = monotonic_seconds() - started - searching;
+    double probe_seconds_per_node = visited > 0 ? elapsed / (double)visited : 0.0;
+    /*
+     * Every prediction is timed at the real search rate. Tiny searches mostly time their
+     * setup, so fall back to the probe rate unless the searches covered many nodes.
+     */
+    double seconds_per_node = search_nodes >= ESTIMATE_RATE_MIN_NODES
+                                  ? searching / search_nodes
+                                  : probe_seconds_per_node;
+    mem_free(state);
+    mem_free(pos);
+
+    /* A search that ends at bound B runs every earlier bound in full and, on average, half of B. */
+    double before = 0.0;
+    for (int i = 0; i < count; i++) {
+        estimates[i].if_optimal = before + estimates[i].nodes / 2.0;
+        before += estimates[i].nodes;
+    }
+
+    printf("%6s %8s %16s %10s %18s %12s %14s\n", "bound", "probes", "nodes", "stderr",
+           "if optimal: nodes", "seconds", "searched");
+    for (int i = 0; i < count; i++) {
+        const BoundEstimate *estimate = &estimates[i];
+        printf("%6d %8d %16.0f %9.1f%% %18.0f %12.3f ", estimate->bound, estimate->probes,
+               estimate->nodes,
+               estimate->nodes > 0.0 ? 100.0 * estimate->error / estimate->nodes : 0.0,
+               estimate->if_optimal, estimate->if_optimal * seconds_per_node);
+        if (estimate->searched >= 0) {
+            printf("%14lld\n", estimate->searched);
+        } else {
+            printf("%14s\n", "-");
+        }
+    }
+    const BoundEstimate *last = &estimates[count - 1];
+    int searched_bound = -1;
+    int searched_next = INT_MAX;
+    for (int i = 0; i < count && estimates[i].searched >= 0; i++) {
+        searched_bound = estimates[i].bound;
+        searched_next = estimates[i].next_bound;
+    }
+
+    /*
+     * Without a goal, carry the growth between the last two completed bounds forward to the
+     * shallowest depth the searches still allow. The real depth is usually deeper, so this
+     * total is only a lower bound on the cost.
+     */
+    double min_nodes = 0.0;
+    int min_bound = last->bound;
+    double growth = 0.0;
+    if (!last->goal) {
+        int base = count - 1;
+        for (int i = 0; i < count && estimates[i].searched >= 0; i++) {
+            base = i;
+        }
+        double nodes_at[ESTIMATE_MAX_BOUNDS];
+        for (int i = 0; i <= base; i++) {
+            nodes_at[i] = estimates[i].searched >= 0 ? (double)estimates[i].searched
+                                                     : estimates[i].nodes;
+        }
+        int step = base > 0 ? estimates[base].bound - estimates[base - 1].bound : 2;
+        if (base > 0 && nodes_at[base - 1] > 0.0) {
+            growth = nodes_at[base] / nodes_at[base - 1];
+        } else if (estimates[base].bound > 0) {
+            growth = pow(fmax(nodes_at[base], 1.0), (double)step / estimates[base].bound);
+        }
+        growth = fmax(growth, 1.0);
+        min_bound = estimates[base].bound;
+        if (searched_next != INT_MAX && searched_next > min_bound) {
+            min_bound = searched_next;
+        }
+        double nodes = nodes_at[base];
+        for (int i = 0; i < base; i++) {
+            min_nodes += nodes_at[i];
+        }
+        for (int b = estimates[base].bound; b < min_bound; b += step) {
+            min_nodes += nodes;
+            nodes *= growth;
+        }
+        min_nodes += nodes / 2.0;
+    }
+    if (last->solved) {
+        printf("IDA* reached the goal at bound %d after %.0f nodes; predicted %.0f.\n",
+               last->bound, searched_before, last->if_optimal);
+    } else if (last->goal) {
+        printf("Probes reached the goal at bound %d: predicted %.0f nodes, %.3f seconds.\n",
+               last->bound, last->if_optimal, last->if_optimal * seconds_per_node);
+    } else {
+        if (searched_bound >= 0) {
+            printf("IDA* found no solution within bound %d, so it needs more moves.\n",
+                   searched_bound);
+        } else {
+            printf("No probe reached the goal, so the depth is unknown.\n");
+        }
+        printf("Lower bound, extrapolated to bound %d with growth %.2f per bound: at least "
+               "%.0f nodes, %.3f seconds; a deeper solution costs more.\n",
+               min_bound, growth, min_nodes,
+               min_nodes * seconds_per_node);
+    }
+
+    if (options->report_path) {
+        OutputBuffer out;
+        if (!output_open(&out, options->report_path)) {
+            fprintf(stderr, "Failed to write %s: %s\n", options->report_path, strerror(errno));
+            return false;
+        }
+        output_format(&out, "{\n  \"rows\": %d,\n  \"cols\": %d,\n  \"seconds_per_node\": %.3e,"
+                            "\n  \"goal_bound\": ", rows, cols, seconds_per_node);
+        if (last->goal) {
+            output_format(&out, "%d,\n  \"predicted_nodes\": %.0f,\n", last->bound,
+                          last->if_optimal);
+        } else {
+            output_bytes(&out, "null,\n", 6);
+        }
+        if (last->solved) {
+            output_format(&out, "  \"searched_nodes\": %.0f,\n", searched_before);
+        }
+        if (!last->goal) {
+            output_format(&out, "  \"min_bound\": %d,\n  \"growth\": %.3f,\n"
+                                "  \"min_nodes\": %.0f,\n"
+                                "  \"min_seconds\": %.6f,\n",
+                          min_bound, growth, min_nodes,
+                          min_nodes * seconds_per_node);
+        }
+        output_bytes(&out, "  \"bounds\": [\n", 14);
+        for (int i = 0; i < count; i++) {
+            const BoundEstimate *estimate = &estimates[i];
+            output_format(&out, "    {\"bound\": %d, \"probes\": %d, \"nodes\": %.0f, "
+                                "\"stderr\": %.0f, \"if_optimal_nodes\": %.0f, "
+                                "\"if_optimal_seconds\": %.6f, \"searched\": ",
+                          estimate->bound, estimate->probes, estimate->nodes, estimate->error,
+                          estimate->if_optimal, estimate->if_optimal * seconds_per_node);
+            if (estimate->searched >= 0) {
+                output_format(&out, "%lld}%s\n", estimate->searched, i + 1 < count ? "," : "");
+            } else {
+                output_format(&out, "null}%s\n", i + 1 < count ? "," : "");
+            }
+        }
+        output_bytes(&out, "  ]\n}\n", 6);
+        if (!output_close(&out)) {
+            fprintf(stderr, "Failed to write %s: %s\n", options->report_path, strerror(errno));
+            return false;
+        }
+    }
+    return true;
+}
+
+static int heuristic_manhattan(const int *state, int rows, int cols, TranspositionTable *table) {
+    (void)table;
+    return (int)manhattan_distance(state, rows, cols);
+}
+
+static int heuristic_misplaced(const int *state, int rows, int cols, TranspositionTable *table) {
+    (void)table;
+    int len = rows * cols;
+    int misplaced = 0;
+    for (int i = 0; i < len; i++) {
+        misplaced += state[i] != -1 && state[i] != i;
+    }
+    return misplaced;
+}
+
+static int heuristic_table(const int *state, int rows, int cols, TranspositionTable *table) {
+    int h = (int)manhattan_distance(state, rows, cols);
+    int learned = table_probe(table, board_key(state, rows * cols));
+    return learned > h ? learned : h;
+}
+
+static const HeuristicProfile heuristic_profiles[] = {
+    {"manhattan", heuristic_manhattan, false},
+    {"misplaced", heuristic_misplaced, false},
+    {"manhattan+tt", heuristic_table, true}
+};
+
+#define HEURISTIC_COUNT ((int)(sizeof(heuristic_profiles) / sizeof(heuristic_profiles[0])))
+
+static uint32_t permutation_rank(const int *state, int len) {
+    uint32_t rank = 0;
+    for (int i = 0; i < len; i++) {
+        size_t slot = tile_slot(state[i], len);
+        uint32_t smaller = 0;
+        for (int j = i + 1; j < len; j++) {
+            smaller += tile_slot(state[j], len) < slot;
+        }
+        rank = rank * (uint32_t)(len - i) + smaller;
+    }
+    return rank;
+}
+
+static void permutation_unrank(uint32_t rank, int *state, int len, int *blank_index) {
+    int digits[PROFILE_BFS_MAX_CELLS];
+    for (int i = len - 1; i >= 0; i--) {
+        digits[i] = (int)(rank % (uint32_t)(len - i));
+        rank /= (uint32_t)(len - i);
+    }
+    bool used[PROFILE_BFS_MAX_CELLS] = {false};
+    for (int i = 0; i < len; i++) {
+        int slot = 0;
+        for (int skip = digits[i];; slot++) {
+            if (!used[slot] && skip-- == 0) {
+                break;
+            }
+        }
+        used[slot] = true;
+        state[i] = slot == len - 1 ? -1 : slot;
+        if (state[i] == -1) {
+            *blank_index = i;
+        }
+    }
+}
+
+/* Breadth-first search back from the goal gives the exact distance of every reachable board. */
+static unsigned char *exact_distances(int rows, int cols) {
+    int len = rows * cols;
+    uint32_t states = 1;
+    for (int i = 2; i <= len; i++) {
+        states *= (uint32_t)i;
+    }
+    unsigned char *distance = mem_alloc(MEM_SEARCH, states);
+    uint32_t *queue = mem_alloc(MEM_SEARCH, sizeof(uint32_t) * (states / 2 + 1));
+    if (!distance || !queue) {
+        fprintf(stderr, "Failed to allocate the exact distance table.\n");
+        mem_free(distance);
+        mem_free(queue);
+        return NULL;
+    }
+    memset(distance, 0xFF, states);
+
+    int state[PROFILE_BFS_MAX_CELLS];
+    for (int i = 0; i < len; i++) {
+        state[i] = i + 1 < len ? i : -1;
+    }
+    size_t head = 0;
+    size_t tail = 0;
+    queue[tail++] = permutation_rank(state, len);
+    distance[queue[0]] = 0;
+    const char moves[4] = {'U', 'D', 'L', 'R'};
+    while (head < tail) {
+        uint32_t rank = queue[head++];
+        int blank_index = 0;
+        permutation_unrank(rank, state, len, &blank_index);
+        for (int i = 0; i < 4; i++) {
+            int prior_blank = blank_index;
+            if (!apply_move(state, NULL, rows, cols, &blank_index, moves[i])) {
+                continue;
+            }
+            uint32_t next = permutation_rank(state, len);
+            if (distance[next] == 0xFF) {
+                distance[next] = (unsigned char)(distance[rank] + 1);
+                queue[tail++] = next;
+            }
+            apply_move(state, NULL, rows, cols, &blank_index, opposite_move(moves[i]));
+            blank_index = prior_blank;
+        }
+    }
+    mem_free(queue);
+    return distance;
+}
+
+static int ratio_bucket(int h, int exact) {
+    if (exact == 0 || h >= exact) {
+        return PROFILE_RATIO_BUCKETS;
+    }
+    return h * PROFILE_RATIO_BUCKETS / exact;
+}
+
+static bool profile_heuristics(int rows, int cols, int samples, const Options *options) {
+    int len = rows * cols;
+    if (len > PROFILE_MAX_CELLS) {
+        fprintf(stderr, "Heuristic profiles need a board of at most %d cells.\n",
+                PROFILE_MAX_CELLS);
+        return false;
+    }
+    bool use_bfs = len <= PROFILE_BFS_MAX_CELLS;
+    unsigned char *distance = use_bfs ? exact_distances(rows, cols) : NULL;
+    TranspositionTable table = {.path = options->table_path};
+    bool have_table = options->table_path && table_load(&table, options->table_path, rows, cols);
+    int *boards = mem_alloc(MEM_SEARCH, sizeof(int) * (size_t)len * (size_t)samples);
+    int *exact = mem_alloc(MEM_SEARCH, sizeof(int) * (size_t)samples);
+    int *values = mem_alloc(MEM_SEARCH, sizeof(int) * (size_t)samples * HEURISTIC_COUNT);
+    int *pos = mem_alloc(MEM_SEARCH, sizeof(int) * (size_t)len);
+    bool ok = (!use_bfs || distance) && boards && exact && values && pos;
+    if (!ok) {
+        fprintf(stderr, "Failed to allocate heuristic samples.\n");
+    }
+
+    Rng rng;
+    rng_seed(&rng, options->has_seed ? options->seed : 1);
+    Options solve_options = {.moves_path = "/dev/null", .quiet = true};
+    for (int s = 0; s < samples && ok; s++) {
+        int *board = boards + (size_t)s * (size_t)len;
+        int blank_index = 0;
+        if (use_bfs) {
+            if (!shuffle_state(board, rows, cols, &rng, &blank_index)) {
+                ok = false;
+                break;
+            }
+            exact[s] = distance[permutation_rank(board, len)];
+            continue;
+        }
+        int depth = (int)rng_below(&rng, PROFILE_MAX_SCRAMBLE + 1);
+        scramble_state(board, rows, cols, depth, &rng, &blank_index);
+        int *state = boards + (size_t)s * (size_t)len;
+        int scratch[PROFILE_MAX_CELLS];
+        memcpy(scratch, state, sizeof(int) * (size_t)len);
+        for (int i = 0; i < len; i++) {
+            pos[tile_slot(scratch[i], len)] = i;
+        }
+        SolveStats stats;
+        solve_puzzle(scratch, pos, rows, cols, blank_index, &solve_options, &stats);
+        exact[s] = stats.solved ? (int)stats.length : -1;
+        ok = stats.solved;
+    }
+
+    double ns_per_eval[HEURISTIC_COUNT] = {0};
+    for (int k = 0; k < HEURISTIC_COUNT && ok; k++) {
+        const HeuristicProfile *profile = &heuristic_profiles[k];
+        if (profile->needs_table && !have_table) {
+            continue;
+        }
+        for (int s = 0; s < samples; s++) {
+            values[(size_t)s * HEURISTIC_COUNT + (size_t)k] =
+                profile->evaluate(boards + (size_t)s * (size_t)len, rows, cols, &table);
+        }
+        volatile long long sink = 0;
+        double started = monotonic_seconds();
+        for (int round = 0; round < PROFILE_TIMING_ROUNDS; round++) {
+            for (int s = 0; s < samples; s++) {
+                sink += profile->evaluate(boards + (size_t)s * (size_t)len, rows, cols, &table);
+            }
+        }
+        ns_per_eval[k] = (monotonic_seconds() - started) * 1e9 /
+                         ((double)PROFILE_TIMING_ROUNDS * (double)samples);
+    }
+
+    if (ok) {
+        printf("%d samples of %dx%d boards, exact distances by %s.\n", samples, rows, cols,
+               use_bfs ? "breadth-first search" : "optimal IDA*");
+        printf("%-14s %10s %10s %10s %10s %12s\n", "heuristic", "mean h/h*", "exact",
+               "mean err", "ns/eval", "bytes");
+        for (int k = 0; k < HEURISTIC_COUNT; k++) {
+            if (heuristic_profiles[k].needs_table && !have_table) {
+                continue;
+            }
+            double ratio = 0.0;
+            double error = 0.0;
+            int exact_hits = 0;
+            for (int s = 0; s < samples; s++) {
+                int h = values[(size_t)s * HEURISTIC_COUNT + (size_t)k];
+                ratio += exact[s] > 0 ? (double)h / exact[s] : 1.0;
+                error += exact[s] - h;
+                exact_hits += h == exact[s];
+            }
+            size_t bytes = heuristic_profiles[k].needs_table
+                               ? sizeof(TableEntry) * (table.mask + 1)
+                               : 0;
+            printf("%-14s %10.3f %9.1f%% %10.2f %10.1f %12zu\n", heuristic_profiles[k].name,
+                   ratio / samples, 100.0 * exact_hits / samples, error / samples,
+                   ns_per_eval[k], bytes);
+        }
+
+        printf("\nh/h* histogram\n%-12s", "bucket");
+        for (int k = 0; k < HEURISTIC_COUNT; k++) {
+            if (!heuristic_profiles[k].needs_table || have_table) {
+                printf(" %14s", heuristic_profiles[k].name);
+            }
+        }
+        printf("\n");
+        for (int bucket = 0; bucket <= PROFILE_RATIO_BUCKETS; bucket++) {
+            if (bucket == PROFILE_RATIO_BUCKETS) {
+                printf("%-12s", "1.00");
+            } else {
+                printf("[%.2f,%.2f) ", (double)bucket / PROFILE_RATIO_BUCKETS,
+                       (double)(bucket + 1) / PROFILE_RATIO_BUCKETS);
+            }
+            for (int k = 0; k < HEURISTIC_COUNT; k++) {
+                if (heuristic_profiles[k].needs_table && !have_table) {
+                    continue;
+                }
+                int count = 0;
+                for (int s = 0; s < samples; s++) {
+                    count += ratio_bucket(values[(size_t)s * HEURISTIC_COUNT + (size_t)k],
+                                          exact[s]) == bucket;
+                }
+                printf(" %14d", count);
+            }
+            printf("\n");
+        }
+
+        int max_error = 0;
+        for (int s = 0; s < samples; s++) {
+            for (int k = 0; k < HEURISTIC_COUNT; k++) {
+                if (!heuristic_profiles[k].needs_table || have_table) {
+                    int error = exact[s] - values[(size_t)s * HEURISTIC_COUNT + (size_t)k];
+                    max_error = error > max_error ? error : max_error;
+                }
+            }
+        }
+        printf("\nError (h* - h) histogram\n%-12s", "error");
+        for (int k = 0; k < HEURISTIC_COUNT; k++) {
+            if (!heuristic_profiles[k].needs_table || have_table) {
+                printf(" %14s", heuristic_profiles[k].name);
+            }
+        }
+        printf("\n");
+        for (int error = 0; error <= max_error; error++) {
+            printf("%-12d", error);
+            for (int k = 0; k < HEURISTIC_COUNT; k++) {
+                if (heuristic_profiles[k].needs_table && !have_table) {
+                    continue;
+                }
+                int count = 0;
+                for (int s = 0; s < samples; s++) {
+                    count += exact[s] - values[(size_t)s * HEURISTIC_COUNT + (size_t)k] == error;
+                }
+                printf(" %14d", count);
+            }
+            printf("\n");
+        }
+
+        printf("\nMean error (h* - h) by exact distance\n%-6s %8s", "h*", "samples");
+        for (int k = 0; k < HEURISTIC_COUNT; k++) {
+            if (!heuristic_profiles[k].needs_table || have_table) {
+                printf(" %14s", heuristic_profiles[k].name);
+            }
+        }
+        printf("\n");
+        int max_depth = 0;
+        for (int s = 0; s < samples; s++) {
+            max_depth = exact[s] > max_depth ? exact[s] : max_depth;
+        }
+        for (int depth = 0; depth <= max_depth; depth++) {
+            int count = 0;
+            double error[HEURISTIC_COUNT] = {0};
+            for (int s = 0; s < samples; s++) {
+                if (exact[s] != depth) {
+                    continue;
+                }
+                count++;
+                for (int k = 0; k < HEURISTIC_COUNT; k++) {
+                    if (!heuristic_profiles[k].needs_table || have_table) {
+                        error[k] += depth - values[(size_t)s * HEURISTIC_COUNT + (size_t)k];
+                    }
+                }
+            }
+            if (count == 0) {
+                continue;
+            }
+            printf("%-6d %8d", depth, count);
+            for (int k = 0; k < HEURISTIC_COUNT; k++) {
+                if (!heuristic_profiles[k].needs_table || have_table) {
+                    printf(" %14.2f", error[k] / count);
+                }
+            }
+            printf("\n");
+        }
+    }
+
+    if (have_table) {
+        table_free(&table);
+    }
+    mem_free(distance);
+    mem_free(boards);
+    mem_free(exact);
+    mem_free(values);
+    mem_free(pos);
+    return ok;
+}
+
+static const int step_row[4] = {-1, 1, 0, 0};
+static const int step_col[4] = {0, 0, -1, 1};
+
+static inline int reducer_index(const Reducer *reducer, int row, int col) {
+    return reducer->transposed ? col * reducer->cols + row : row * reducer->cols + col;
+}
+
+static inline void reducer_coords(const Reducer *reducer, int index, int *row, int *col) {
+    int r = index / reducer->cols;
+    int c = index % reducer->cols;
+    *row = reducer->transposed ? c : r;
+    *col = reducer->transposed ? r : c;
+}
+
+static inline int reducer_height(const Reducer *reducer) {
+    return reducer->transposed ? reducer->cols : reducer->rows;
+}
+
+static inline int reducer_width(const Reducer *reducer) {
+    return reducer->transposed ? reducer->rows : reducer->cols;
+}
+
+static inline int reducer_top(const Reducer *reducer) {
+    return reducer->transposed ? reducer->left : reducer->top;
+}
+
+static inline int reducer_left(const Reducer *reducer) {
+    return reducer->transposed ? reducer->top : reducer->left;
+}
+
+static bool reducer_free(const Reducer *reducer, int row, int col) {
+    int top = reducer_top(reducer);
+    if (row < top || row >= reducer_height(reducer) || col < reducer_left(reducer) ||
+        col >= reducer_width(reducer)) {
+        return false;
+    }
+    if (row == top && col < reducer->lock_col) {
+        return false;
+    }
+    int index = reducer_index(reducer, row, col);
+    for (int i = 0; i < reducer->obstacle_count; i++) {
+        if (reducer->pos[reducer->obstacles[i]] == index) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void reducer_orient(Reducer *reducer, bool transposed) {
+    int cols = reducer->cols;
+    reducer->transposed = transposed;
+    reducer->offsets[0] = transposed ? -1 : -cols;
+    reducer->offsets[1] = transposed ? 1 : cols;
+    reducer->offsets[2] = transposed ? -cols : -1;
+    reducer->offsets[3] = transposed ? cols : 1;
+    reducer_coords(reducer, reducer->blank, &reducer->blank_row, &reducer->blank_col);
+}
+
+static void reducer_step(Reducer *reducer, int direction) {
+    static const char moves[2][4] = {{'U', 'D', 'L', 'R'}, {'L', 'R', 'U', 'D'}};
+    char move = moves[reducer->transposed][direction];
+    int from = reducer->blank;
+    int to = from + reducer->offsets[direction];
+    int tile = reducer->state[to];
+    reducer->state[from] = tile;
+    reducer->state[to] = -1;
+    reducer->pos[tile] = from;
+    reducer->blank = to;
+    reducer->blank_row += step_row[direction];
+    reducer->blank_col += step_col[direction];
+    output_reserve(&reducer->out, 2);
+    reducer->out.data[reducer->out.used++] = move;
+    reducer->out.data[reducer->out.used++] = '\n';
+    reducer->moves++;
+}
+
+static int direction_of(int d_row, int d_col) {
+    return d_row < 0 ? 0 : d_row > 0 ? 1 : d_col < 0 ? 2 : 3;
+}
+
+static bool reducer_search(Reducer *reducer, int target_row, int target_col, int row0, int row1,
+                           int col0, int col1) {
+    if (++reducer->generation == 0) {
+        size_t len = (size_t)reducer->rows * (size_t)reducer->cols;
+        memset(reducer->visit, 0, sizeof(unsigned int) * len);
+        reducer->generation = 1;
+    }
+    int start = reducer->blank;
+    int target = reducer_index(reducer, target_row, target_col);
+    size_t head = 0;
+    size_t tail = 0;
+    reducer->queue[tail++] = start;
+    reducer->visit[start] = reducer->generation;
+    bool found = false;
+    while (head < tail) {
+        int index = reducer->queue[head++];
+        if (index == target) {
+            found = true;
+            break;
+        }
+        int row;
+        int col;
+        reducer_coords(reducer, index, &row, &col);
+        for (int d = 0; d < 4; d++) {
+            int next_row = row + step_row[d];
+            int next_col = col + step_col[d];
+            if (next_row < row0 || next_row > row1 || next_col < col0 || next_col > col1 ||
+                !reducer_free(reducer, next_row, next_col)) {
+                continue;
+            }
+            int next = reducer_index(reducer, next_row, next_col);
+            if (reducer->visit[next] == reducer->generation) {
+                continue;
+            }
+            reducer->visit[next] = reducer->generation;
+            reducer->via[next] = (unsigned char)d;
+            reducer->queue[tail++] = next;
+        }
+    }
+    if (!found) {
+        return false;
+    }
+
+    size_t length = 0;
+    for (int index = target; index != start;) {
+        int d = reducer->via[index];
+        reducer->route[length++] = (unsigned char)d;
+        int row;
+        int col;
+        reducer_coords(reducer, index, &row, &col);
+        index = reducer_index(reducer, row - step_row[d], col - step_col[d]);
+    }
+    while (length > 0) {
+        reducer_step(reducer, reducer->route[--length]);
+    }
+    return true;
+}
+
+static bool reducer_route(Reducer *reducer, int row, int col) {
+    while (true) {
+        int blank_row = reducer->blank_row;
+        int blank_col = reducer->blank_col;
+        if (blank_row == row && blank_col == col) {
+            return true;
+        }
+        int d_row = (row > blank_row) - (row < blank_row);
+        int d_col = (col > blank_col) - (col < blank_col);
+        if (d_col != 0 && reducer_free(reducer, blank_row, blank_col + d_col)) {
+            reducer_step(reducer, direction_of(0, d_col));
+            continue;
+        }
+        if (d_row != 0 && reducer_free(reducer, blank_row + d_row, blank_col)) {
+            reducer_step(reducer, direction_of(d_row, 0));
+            continue;
+        }
+        if (d_row == 0 || d_col == 0) {
+            bool detoured = false;
+            for (int side = 1; side >= -1 && !detoured; side -= 2) {
+                int side_row = d_row == 0 ? side : 0;
+                int side_col = d_col == 0 ? side : 0;
+                int r = blank_row + side_row;
+                int c = blank_col + side_col;
+                if (reducer_free(reducer, r, c) &&
+                    reducer_free(reducer, r + d_row, c + d_col) &&
+                    reducer_free(reducer, r + 2 * d_row, c + 2 * d_col)) {
+                    reducer_step(reducer, direction_of(side_row, side_col));
+                    reducer_step(reducer, direction_of(d_row, d_col));
+                    reducer_step(reducer, direction_of(d_row, d_col));
+                    detoured = true;
+                }
+            }
+            if (detoured) {
+                continue;
+            }
+        }
+
+        int height = reducer_height(reducer);
+        int width = reducer_width(reducer);
+        int top = reducer_top(reducer);
+        int left = reducer_left(reducer);
+        int row0 = (row < blank_row ? row : blank_row) - 2;
+        int row1 = (row > blank_row ? row : blank_row) + 2;
+        int col0 = (col < blank_col ? col : blank_col) - 2;
+        int col1 = (col > blank_col ? col : blank_col) + 2;
+        return reducer_search(reducer, row, col, row0 < top ? top : row0,
+                              row1 >= height ? height - 1 : row1, col0 < left ? left : col0,
+                              col1 >= width ? width - 1 : col1) ||
+               reducer_search(reducer, row, col, top, height - 1, left, width - 1);
+    }
+}
+
+static bool reducer_move_tile(Reducer *reducer, int tile, int goal_row, int goal_col) {
+    reducer->obstacles[reducer->obstacle_count++] = tile;
+    bool ok = true;
+    while (ok) {
+        int row;
+        int col;
+        reducer_coords(reducer, reducer->pos[tile], &row, &col);
+        if (row == goal_row && col == goal_col) {
+            break;
+        }
+        int next_row = row;
+        int next_col = col;
+        if (col != goal_col && row != goal_row) {
+            int blank_row = reducer->blank_row;
+            int blank_col = reducer->blank_col;
+            int vertical_row = row + (row < goal_row ? 1 : -1);
+            int horizontal_col = col + (col < goal_col ? 1 : -1);
+            bool behind_row = blank_col == col && blank_row == 2 * row - vertical_row;
+            bool behind_col = blank_row == row && blank_col == 2 * col - horizontal_col;
+            int vertical_cost = abs(blank_row - vertical_row) + abs(blank_col - col) +
+                                (behind_row ? 2 : 0);
+            int horizontal_cost = abs(blank_row - row) + abs(blank_col - horizontal_col) +
+                                  (behind_col ? 2 : 0);
+            if (vertical_cost < horizontal_cost && reducer_free(reducer, vertical_row, col)) {
+                next_row = vertical_row;
+            } else {
+                next_col = horizontal_col;
+            }
+        } else if (col != goal_col) {
+            next_col += col < goal_col ? 1 : -1;
+        } else {
+            next_row += row < goal_row ? 1 : -1;
+        }
+        ok = reducer_route(reducer, next_row, next_col);
+        if (ok) {
+            reducer_step(reducer, direction_of(row - next_row, col - next_col));
+        }
+    }
+    reducer->obstacle_count--;
+    return ok;
+}
+
+static int window_slot(const int *cells, int cell_count, int index) {
+    for (int i = 0; i < cell_count; i++) {
+        if (cells[i] == index) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static bool reducer_window(Reducer *reducer, int row0, int col0, int rows, int cols,
+                           const int *tiles, int tile_count) {
+    int cell_count = rows * cols;
+    int items = tile_count + 1;
+    int cells[WINDOW_MAX_CELLS];
+    int start_slots[4];
+    int goals[3];
+    for (int i = 0; i < cell_count; i++) {
+        cells[i] = reducer_index(reducer, row0 + i / cols, col0 + i % cols);
+    }
+    start_slots[0] = window_slot(cells, cell_count, reducer->blank);
+    for (int i = 0; i < tile_count; i++) {
+        start_slots[i + 1] = window_slot(cells, cell_count, reducer->pos[tiles[i]]);
+        goals[i] = window_slot(cells, cell_count, tiles[i]);
+    }
+
+    int state_count = 1;
+    int start = 0;
+    for (int i = items - 1; i >= 0; i--) {
+        if (start_slots[i] < 0) {
+            return false;
+        }
+        state_count *= cell_count;
+        start = start * cell_count + start_slots[i];
+    }
+
+    short previous[WINDOW_MAX_STATES];
+    unsigned char moved[WINDOW_MAX_STATES];
+    short queue[WINDOW_MAX_STATES];
+    for (int i = 0; i < state_count; i++) {
+        previous[i] = -1;
+    }
+    previous[start] = (short)start;
+    int head = 0;
+    int tail = 0;
+    int found = -1;
+    queue[tail++] = (short)start;
+    while (head < tail) {
+        int code = queue[head++];
+        int slots[4];
+        for (int i = 0, rest = code; i < items; i++, rest /= cell_count) {
+            slots[i] = rest % cell_count;
+        }
+        bool solved = true;
+        for (int i = 0; i < tile_count; i++) {
+            solved = solved && slots[i + 1] == goals[i];
+        }
+        if (solved) {
+            found = code;
+            break;
+        }
+        int row = slots[0] / cols;
+        int col = slots[0] % cols;
+        for (int d = 0; d < 4; d++) {
+            int next_row = row + step_row[d];
+            int next_col = col + step_col[d];
+            if (next_row < 0 || next_row >= rows || next_col < 0 || next_col >= cols) {
+                continue;
+            }
+            int slot = next_row * cols + next_col;
+            int next = 0;
+            for (int i = items - 1; i >= 0; i--) {
+                int value = i == 0 ? slot : slots[i] == slot ? slots[0] : slots[i];
+                next = next * cell_count + value;
+            }
+            if (previous[next] >= 0) {
+                continue;
+            }
+            previous[next] = (short)code;
+            moved[next] = (unsigned char)d;
+            queue[tail++] = (short)next;
+        }
+    }
+    if (found < 0) {
+        return false;
+    }
+
+    unsigned char path[WINDOW_MAX_STATES];
+    int length = 0;
+    for (int code = found; code != start; code = previous[code]) {
+        path[length++] = moved[code];
+    }
+    while (length > 0) {
+        reducer_step(reducer, path[--length]);
+    }
+    return true;
+}
+
+static bool reducer_line(Reducer *reducer) {
+    int width = reducer_width(reducer);
+    int top = reducer_top(reducer);
+    for (int col = reducer_left(reducer); col < width - 2; col++) {
+        reducer->lock_col = col;
+        if (!reducer_move_tile(reducer, reducer_index(reducer, top, col), top, col)) {
+            return false;
+        }
+    }
+
+    reducer->lock_col = width - 2;
+    int tiles[2] = {reducer_index(reducer, top, width - 2),
+                    reducer_index(reducer, top, width - 1)};
+    if (reducer->pos[tiles[0]] == tiles[0] && reducer->pos[tiles[1]] == tiles[1]) {
+        return true;
+    }
+    if (!reducer_move_tile(reducer, tiles[0], top, width - 1)) {
+        return false;
+    }
+
+    reducer->obstacles[reducer->obstacle_count++] = tiles[0];
+    int row;
+    int col;
+    reducer_coords(reducer, reducer->pos[tiles[1]], &row, &col);
+    bool ok = (row <= top + 2 && col >= width - 2) ||
+              reducer_move_tile(reducer, tiles[1], top + 2, width - 2);
+    if (ok && (reducer->blank_row > top + 2 || reducer->blank_col < width - 2)) {
+        reducer->obstacles[reducer->obstacle_count++] = tiles[1];
+        bool corner = reducer->pos[tiles[1]] == reducer_index(reducer, top + 2, width - 1);
+        ok = reducer_route(reducer, top + 2, corner ? width - 2 : width - 1);
+    }
+    reducer->obstacle_count = 0;
+    return ok && reducer_window(reducer, top, width - 2, 3, 2, tiles, 2);
+}
+
+static void solve_constructive(int *state, int *pos, int rows, int cols, int blank_index,
+                               const Options *options, SolveStats *stats) {
+    *stats = (SolveStats){0};
+    if (rows < 2 || cols < 2) {
+        fprintf(stderr, "Row and column reduction needs at least two rows and two columns.\n");
+        return;
+    }
+    size_t len = (size_t)rows * (size_t)cols;
+    Reducer reducer = {.state = state, .pos = pos, .rows = rows, .cols = cols,
+                       .blank = blank_index};
+    reducer.visit = mem_calloc(MEM_REDUCER, len, sizeof(unsigned int));
+    reducer.queue = mem_alloc(MEM_REDUCER, sizeof(int) * len);
+    reducer.via = mem_alloc(MEM_REDUCER, len);
+    reducer.route = mem_alloc(MEM_REDUCER, len);
+    bool ok = reducer.visit && reducer.queue && reducer.via && reducer.route;
+    if (!ok) {
+        fprintf(stderr, "Failed to allocate reduction state.\n");
+    } else if (!output_open(&reducer.out, options->moves_path)) {
+        fprintf(stderr, "Failed to write move file: %s\n", options->moves_path);
+        ok = false;
+    }
+
+    if (ok) {
+        while (ok && (rows - reducer.top > 2 || cols - reducer.left > 2)) {
+            int height = rows - reducer.top;
+            int width = cols - reducer.left;
+            reducer_orient(&reducer, height <= 2 || height < width);
+            ok = reducer_line(&reducer);
+            if (reducer.transposed) {
+                reducer.left++;
+            } else {
+                reducer.top++;
+            }
+        }
+        reducer_orient(&reducer, false);
+        int corner = rows * cols - 1;
+        int tiles[3] = {corner - cols - 1, corner - cols, corner - 1};
+        ok = ok && reducer_window(&reducer, rows - 2, cols - 2, 2, 2, tiles, 3);
+        if (!output_close(&reducer.out)) {
+            fprintf(stderr, "Failed to write move file: %s\n", options->moves_path);
+        } else if (!ok) {
+            fprintf(stderr, "Row and column reduction failed to place every tile.\n");
+        } else {
+            stats->solved = true;
+            stats->length = reducer.moves;
+            if (!options->quiet) {
+                printf("Reduction solution length: %llu moves\n", reducer.moves);
+                printf("Tiles out of place: %d\n", count_misplaced(state, (int)len));
+            }
+        }
+    }
+
+    mem_free(reducer.visit);
+    mem_free(reducer.queue);
+    mem_free(reducer.via);
+    mem_free(reducer.route);
+}
+
+static uint64_t instance_seed(uint64_t base, long long index) {
+    return mix64(base + (uint64_t)(index + 1) * 0x9E3779B97F4A7C15ULL);
+}
+
+static void instance_path(const Corpus *corpus, long long index, char *path, size_t size) {
+    if (corpus->pack_path) {
+        snprintf(path, size, "%s", corpus->pack_path);
+    } else {
+        snprintf(path, size, "%s/instance_%06lld.txt", corpus->dir, index);
+    }
+}
+
+static bool pack_instance(const Corpus *corpus, long long index, const int *state) {
+    size_t size = sizeof(int32_t) * (size_t)corpus->n * (size_t)corpus->n;
+    off_t offset = (off_t)(sizeof(PackHeader) + size * (size_t)index);
+    const char *data = (const char *)state;
+    while (size > 0) {
+        ssize_t written = pwrite(corpus->pack_fd, data, size, offset);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            fprintf(stderr, "Failed to write %s: %s\n", corpus->pack_path, strerror(errno));
+            return false;
+        }
+        data += written;
+        size -= (size_t)written;
+        offset += written;
+    }
+    return true;
+}
+
+static void *corpus_worker(void *arg) {
+    Corpus *corpus = *(Corpus **)arg;
+    int n = corpus->n;
+    int *state = mem_alloc(MEM_BOARD, sizeof(int) * (size_t)n * (size_t)n);
+    if (!state) {
+        fprintf(stderr, "Failed to allocate puzzle state.\n");
+        atomic_store(&corpus->failed, true);
+        return NULL;
+    }
+
+    char path[PATH_MAX];
+    while (!atomic_load_explicit(&corpus->failed, memory_order_relaxed)) {
+        long long index = atomic_fetch_add(&corpus->next, 1);
+        if (index >= corpus->count) {
+            break;
+        }
+        double traced = trace_begin();
+        uint64_t seed = instance_seed(corpus->seed, index);
+        Rng rng;
+        rng_seed(&rng, seed);
+        int blank_index = 0;
+        if (corpus->kind == CORPUS_SCRAMBLE) {
+            scramble_state(state, n, n, corpus->depth, &rng, &blank_index);
+        } else {
+            if (!shuffle_state(state, n, n, &rng, &blank_index)) {
+                atomic_store(&corpus->failed, true);
+                break;
+            }
+        }
+
+        int parity = inversion_parity(state, n * n, blank_index);
+        if (parity < 0) {
+            atomic_store(&corpus->failed, true);
+            break;
+        }
+        corpus->seeds[index] = seed;
+        corpus->parities[index] = (unsigned char)parity;
+        board_digest(state, n, n, corpus->digests[index]);
+        bool written;
+        if (corpus->pack_path) {
+            written = pack_instance(corpus, index, state);
+        } else {
+            instance_path(corpus, index, path, sizeof(path));
+            written = write_ini_file(path, state, n, n);
+        }
+        if (!written) {
+            atomic_store(&corpus->failed, true);
+        }
+        trace_end("instance", traced, "index", index);
+    }
+    mem_free(state);
+    return NULL;
+}
+
+static bool write_manifest(const Corpus *corpus) {
+    char path[PATH_MAX];
+    if (corpus->pack_path) {
+        snprintf(path, sizeof(path), "%s.manifest.csv", corpus->pack_path);
+    } else {
+        snprintf(path, sizeof(path), "%s/manifest.csv", corpus->dir);
+    }
+    OutputBuffer out;
+    if (!output_open(&out, path)) {
+        fprintf(stderr, "Failed to write %s: %s\n", path, strerror(errno));
+        return false;
+    }
+
+    static const char header[] = "instance,file,size,depth,seed,parity,sha256\n";
+    output_bytes(&out, header, sizeof(header) - 1);
+    char file[PATH_MAX];
+    for (long long i = 0; i < corpus->count; i++) {
+        instance_path(corpus, i, file, sizeof(file));
+        const char *slash = strrchr(file, '/');
+        const char *name = slash ? slash + 1 : file;
+        output_int(&out, i);
+        output_char(&out, ',');
+        output_bytes(&out, name, strlen(name));
+        output_char(&out, ',');
+        output_int(&out, corpus->n);
+        output_char(&out, ',');
+        if (corpus->kind == CORPUS_SCRAMBLE) {
+            output_int(&out, corpus->depth);
+        }
+        output_char(&out, ',');
+        char seed[24];
+        int seed_len = snprintf(seed, sizeof(seed), "%llu",
+                                (unsigned long long)corpus->seeds[i]);
+        output_bytes(&out, seed, (size_t)seed_len);
+        output_char(&out, ',');
+        output_int(&out, corpus->parities[i]);
+        output_char(&out, ',');
+        output_bytes(&out, corpus->digests[i], 64);
+        output_char(&out, '\n');
+    }
+    if (!output_close(&out)) {
+        fprintf(stderr, "Failed to write %s: %s\n", path, strerror(errno));
+        return false;
+    }
+    return true;
+}
+
+static bool open_pack(Corpus *corpus) {
+    corpus->pack_fd = open(corpus->pack_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (corpus->pack_fd < 0) {
+        fprintf(stderr, "Failed to write %s: %s\n", corpus->pack_path, strerror(errno));
+        return false;
+    }
+    PackHeader header = {
+        .n = (uint32_t)corpus->n,
+        .count = (uint64_t)corpus->count
+    };
+    memcpy(header.magic, PACK_MAGIC, sizeof(header.magic));
+    if (pwrite(corpus->pack_fd, &header, sizeof(header), 0) != (ssize_t)sizeof(header)) {
+        fprintf(stderr, "Failed to write %s: %s\n", corpus->pack_path, strerror(errno));
+        close(corpus->pack_fd);
+        return false;
+    }
+    return true;
+}
+
+static bool generate_corpus(Corpus *corpus) {
+    if (corpus->pack_path) {
+        if (!open_pack(corpus)) {
+            return false;
+        }
+    } else if (mkdir(corpus->dir, 0755) != 0 && errno != EEXIST) {
+        fprintf(stderr, "Failed to create %s: %s\n", corpus->dir, strerror(errno));
+        return false;
+    }
+    corpus->seeds = mem_alloc(MEM_CORPUS, sizeof(uint64_t) * (size_t)corpus->count);
+    corpus->parities = mem_alloc(MEM_CORPUS, (size_t)corpus->count);
+    corpus->digests = mem_alloc(MEM_CORPUS, sizeof(*corpus->digests) * (size_t)corpus->count);
+    bool ok = corpus->seeds && corpus->parities && corpus->digests;
+    if (!ok) {
+        fprintf(stderr, "Failed to allocate corpus manifest.\n");
+    } else {
+        atomic_init(&corpus->next, 0);
+        atomic_init(&corpus->failed, false);
+
+        int thread_count = hardware_threads();
+        if (thread_count > corpus->count) {
+            thread_count = (int)corpus->count;
+        }
+        Corpus *workers[MAX_THREADS];
+        for (int i = 0; i < thread_count; i++) {
+            workers[i] = corpus;
+        }
+        run_workers(workers, sizeof(Corpus *), thread_count, corpus_worker);
+        ok = !atomic_load(&corpus->failed);
+    }
+
+    if (corpus->pack_path && close(corpus->pack_fd) != 0) {
+        fprintf(stderr, "Failed to write %s: %s\n", corpus->pack_path, strerror(errno));
+        ok = false;
+    }
+    ok = ok && write_manifest(corpus);
+    mem_free(corpus->seeds);
+    mem_free(corpus->parities);
+    mem_free(corpus->digests);
+    return ok;
+}
+
+static const BenchCase bench_cases[] = {
+    {"3x3-uniform-a", 3, 3, 0, 1, SOLVER_IDA},
+    {"3x3-uniform-b", 3, 3, 0, 2, SOLVER_IDA},
+    {"3x5-scramble-40", 3, 5, 40, 3, SOLVER_IDA},
+    {"4x4-scramble-40", 4, 4, 40, 4, SOLVER_IDA},
+    {"4x4-scramble-60", 4, 4, 60, 5, SOLVER_IDA},
+    {"4x4-scramble-120", 4, 4, 120, 11, SOLVER_IDA},
+    {"5x5-scramble-30", 5, 5, 30, 6, SOLVER_IDA},
+    {"5x5-uniform", 5, 5, 0, 7, SOLVER_CONSTRUCTIVE},
+    {"100x100-uniform", 100, 100, 0, 8, SOLVER_CONSTRUCTIVE},
+    {"250x250-uniform", 250, 250, 0, 9, SOLVER_CONSTRUCTIVE}
+};
+
+#define BENCH_CASE_COUNT ((int)(sizeof(bench_cases) / sizeof(bench_cases[0])))
+
+static double cpu_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static void reset_peak_rss(void) {
+    int fd = open("/proc/self/clear_refs", O_WRONLY);
+    if (fd >= 0) {
+        ssize_t written = write(fd, "5", 1);
+        (void)written;
+        close(fd);
+    }
+}
+
+static int compare_doubles(const void *lhs, const void *rhs) {
+    double a = *(const double *)lhs;
+    double b = *(const double *)rhs;
+    return (a > b) - (a < b);
+}
+
+static void summarize(double *values, int count, Summary *summary) {
+    qsort(values, (size_t)count, sizeof(double), compare_doubles);
+    double total = 0.0;
+    for (int i = 0; i < count; i++) {
+        total += values[i];
+    }
+    summary->min = values[0];
+    summary->p50 = values[(count - 1) / 2];
+    summary->p90 = values[(count * 9 + 9) / 10 - 1];
+    summary->max = values[count - 1];
+    summary->mean = total / count;
+}
+
+static bool bench_case(const BenchCase *bench, int repeat, const Options *options,
+                       BenchResult *result) {
+    size_t len = (size_t)bench->rows * (size_t)bench->cols;
+    int *initial = mem_alloc(MEM_BOARD, sizeof(int) * len);
+    int *state = mem_alloc(MEM_BOARD, sizeof(int) * len);
+    int *pos = mem_alloc(MEM_BOARD, sizeof(int) * len);
+    double *wall = malloc(sizeof(double) * (size_t)repeat);
+    double *cpu = malloc(sizeof(double) * (size_t)repeat);
+    bool ok = initial && state && pos && wall && cpu;
+    if (!ok) {
+        fprintf(stderr, "Failed to allocate benchmark instance %s.\n", bench->name);
+    } else {
+        Rng rng;
+        rng_seed(&rng, bench->seed);
+        int initial_blank = 0;
+        if (bench->depth > 0) {
+            scramble_state(initial, bench->rows, bench->cols, bench->depth, &rng,
+                           &initial_blank);
+        } else {
+            ok = shuffle_state(initial, bench->rows, bench->cols, &rng, &initial_blank);
+        }
+
+        Options run_options = {
+            .moves_path = options->moves_path,
+            .quiet = true
+        };
+        *result = (BenchResult){.bench = bench, .solved = true};
+        for (int run = 0; run < repeat && ok; run++) {
+            memcpy(state, initial, sizeof(int) * len);
+            for (size_t i = 0; i < len; i++) {
+                pos[tile_slot(state[i], (int)len)] = (int)i;
+            }
+            SolveStats stats;
+            reset_peak_rss();
+            double wall_start = monotonic_seconds();
+            double cpu_start = cpu_seconds();
+            if (bench->solver == SOLVER_IDA) {
+                solve_puzzle(state, pos, bench->rows, bench->cols, initial_blank, &run_options,
+                             &stats);
+            } else {
+                solve_constructive(state, pos, bench->rows, bench->cols, initial_blank,
+                                   &run_options, &stats);
+            }
+            wall[run] = monotonic_seconds() - wall_start;
+            cpu[run] = cpu_seconds() - cpu_start;
+            long rss = peak_rss_kb();
+            if (rss > result->peak_rss_kb) {
+                result->peak_rss_kb = rss;
+            }
+            result->solved = result->solved && stats.solved;
+            result->length = stats.length;
+            result->expanded = stats.expanded;
+        }
+        summarize(wall, repeat, &result->wall);
+        summarize(cpu, repeat, &result->cpu);
+        result->nodes_per_sec = result->wall.p50 > 0.0
+                                    ? (double)result->expanded / result->wall.p50
+                                    : 0.0;
+    }
+
+    mem_free(initial);
+    mem_free(state);
+    mem_free(pos);
+    free(wall);
+    free(cpu);
+    return ok;
+}
+
+static void output_summary_json(OutputBuffer *out, const char *name, const Summary *summary) {
+    output_format(out, "\"%s\": {\"min\": %.6f, \"p50\": %.6f, \"p90\": %.6f, \"max\": %.6f, "
+                       "\"mean\": %.6f}", name, summary->min, summary->p50, summary->p90,
+                  summary->max, summary->mean);
+}
+
+static bool write_bench_report(const char *path, const BenchResult *results, int count,
+                               int repeat) {
+    OutputBuffer out;
+    if (!output_open(&out, path)) {
+        fprintf(stderr, "Failed to write %s: %s\n", path, strerror(errno));
+        return false;
+    }
+
+    size_t path_len = strlen(path);
+    if (path_len >= 4 && strcmp(path + path_len - 4, ".csv") == 0) {
+        static const char header[] =
+            "instance,rows,cols,solver,repeat,solved,length,expanded,wall_min,wall_p50,"
+            "wall_p90,wall_max,wall_mean,cpu_min,cpu_p50,cpu_p90,cpu_max,cpu_mean,"
+            "nodes_per_sec,peak_rss_kb\n";
+        output_bytes(&out, header, sizeof(header) - 1);
+        for (int i = 0; i < count; i++) {
+            const BenchResult *result = &results[i];
+            const Summary *wall = &result->wall;
+            const Summary *cpu = &result->cpu;
+            output_format(&out, "%s,%d,%d,%s,%d,%d,%llu,%lld,", result->bench->name,
+                          result->bench->rows, result->bench->cols,
+                          result->bench->solver == SOLVER_IDA ? "ida" : "constructive", repeat,
+                          result->solved, result->length, result->expanded);
+            output_format(&out, "%.6f,%.6f,%.6f,%.6f,%.6f,", wall->min, wall->p50, wall->p90,
+                          wall->max, wall->mean);
+            output_format(&out, "%.6f,%.6f,%.6f,%.6f,%.6f,", cpu->min, cpu->p50, cpu->p90,
+                          cpu->max, cpu->mean);
+            output_format(&out, "%.0f,%ld\n", result->nodes_per_sec, result->peak_rss_kb);
+        }
+    } else {
+        output_format(&out, "{\n  \"repeat\": %d,\n  \"instances\": [\n", repeat);
+        for (int i = 0; i < count; i++) {
+            const BenchResult *result = &results[i];
+            output_format(&out, "    {\"instance\": \"%s\", \"rows\": %d, \"cols\": %d, "
+                                "\"solver\": \"%s\", \"solved\": %s, \"length\": %llu, "
+                                "\"expanded\": %lld,\n     ",
+                          result->bench->name, result->bench->rows, result->bench->cols,
+                          result->bench->solver == SOLVER_IDA ? "ida" : "constructive",
+                          result->solved ? "true" : "false", result->length,
+                          result->expanded);
+            output_summary_json(&out, "wall_seconds", &result->wall);
+            output_bytes(&out, ",\n     ", 7);
+            output_summary_json(&out, "cpu_seconds", &result->cpu);
+            output_format(&out, ",\n     \"nodes_per_sec\": %.0f, \"peak_rss_kb\": %ld}%s\n",
+                          result->nodes_per_sec, result->peak_rss_kb,
+                          i + 1 < count ? "," : "");
+        }
+        output_bytes(&out, "  ]\n}\n", 6);
+    }
+
+    if (!output_close(&out)) {
+        fprintf(stderr, "Failed to write %s: %s\n", path, strerror(errno));
+        return false;
+    }
+    return true;
+}
+
+static bool run_bench_cases(int repeat, const Options *options, BenchResult *results) {
+    int count = BENCH_CASE_COUNT;
+    printf("%-18s %8s %12s %10s %10s %14s %10s\n", "instance", "length", "expanded",
+           "wall p50", "cpu p50", "nodes/sec", "rss KiB");
+    for (int i = 0; i < count; i++) {
+        if (!bench_case(&bench_cases[i], repeat, options, &results[i])) {
+            return false;
+        }
+        const BenchResult *result = &results[i];
+        printf("%-18s %8llu %12lld %9.4fs %9.4fs %14.0f %10ld%s\n", bench_cases[i].name,
+               result->length, result->expanded, result->wall.p50, result->cpu.p50,
+               result->nodes_per_sec, result->peak_rss_kb, result->solved ? "" : " unsolved");
+        fflush(stdout);
+    }
+    return true;
+}
+
+static bool run_bench(int repeat, const Options *options) {
+    BenchResult results[BENCH_CASE_COUNT];
+    if (!run_bench_cases(repeat, options, results) ||
+        !write_bench_report(options->report_path, results, BENCH_CASE_COUNT, repeat)) {
+        return false;
+    }
+    printf("Wrote benchmark report to %s.\n", options->report_path);
+    return true;
+}
+
+static const char *json_field(const char *begin, const char *end, const char *key) {
+    size_t key_len = strlen(key);
+    for (const char *ptr = begin; ptr + key_len + 2 < end; ptr++) {
+        if (*ptr == '"' && memcmp(ptr + 1, key, key_len) == 0 && ptr[key_len + 1] == '"') {
+            const char *value = ptr + key_len + 2;
+            while (value < end && (*value == ':' || *value == ' ')) {
+                value++;
+            }
+            return value;
+        }
+    }
+    return NULL;
+}
+
+static bool load_baseline(const char *path, BaselineEntry **out_entries, int *out_count) {
+    MappedFile file;
+    if (!map_file(path, &file)) {
+        fprintf(stderr, "Failed to open %s: %s\n", path, strerror(errno));
+        return false;
+    }
+    const char *end = file.data + file.size;
+    int capacity = 0;
+    int count = 0;
+    BaselineEntry *entries = NULL;
+    const char *cursor = json_field(file.data, end, "instance");
+    while (cursor) {
+        const char *next = json_field(cursor, end, "instance");
+        const char *stop = next ? next : end;
+        if (count == capacity) {
+            capacity = capacity ? capacity * 2 : 16;
+            BaselineEntry *grown = realloc(entries, sizeof(BaselineEntry) * (size_t)capacity);
+            if (!grown) {
+                fprintf(stderr, "Failed to allocate baseline.\n");
+                free(entries);
+                unmap_file(&file);
+                return false;
+            }
+            entries = grown;
+        }
+
+        BaselineEntry *entry = &entries[count];
+        *entry = (BaselineEntry){0};
+        const char *name = cursor + 1;
+        const char *quote = memchr(name, '"', (size_t)(stop - name));
+        size_t name_len = quote ? (size_t)(quote - name) : 0;
+        if (name_len >= sizeof(entry->name)) {
+            name_len = sizeof(entry->name) - 1;
+        }
+        memcpy(entry->name, name, name_len);
+        const char *length = json_field(cursor, stop, "length");
+        const char *expanded = json_field(cursor, stop, "expanded");
+        const char *wall = json_field(cursor, stop, "wall_seconds");
+        const char *p50 = wall ? json_field(wall, stop, "p50") : NULL;
+        const char *max = wall ? json_field(wall, stop, "max") : NULL;
+        if (!quote || !length || !expanded || !p50 || !max) {
+            fprintf(stderr, "Malformed baseline entry in %s.\n", path);
+            free(entries);
+            unmap_file(&file);
+            return false;
+        }
+        entry->length = strtoull(length, NULL, 10);
+        entry->expanded = strtoll(expanded, NULL, 10);
+        entry->wall_p50 = strtod(p50, NULL);
+        entry->wall_max = strtod(max, NULL);
+        count++;
+        cursor = next;
+    }
+    unmap_file(&file);
+    *out_entries = entries;
+    *out_count = count;
+    return true;
+}
+
+static bool compare_bench(const char *baseline_path, int repeat, const Options *options) {
+    BaselineEntry *baseline = NULL;
+    int baseline_count = 0;
+    if (!load_baseline(baseline_path, &baseline, &baseline_count)) {
+        return false;
+    }
+    BenchResult results[BENCH_CASE_COUNT];
+    if (!run_bench_cases(repeat, options, results)) {
+        free(baseline);
+        return false;
+    }
+    if (options->report_path &&
+        !write_bench_report(options->report_path, results, BENCH_CASE_COUNT, repeat)) {
+        free(baseline);
+        return false;
+    }
+
+    /* Expansions and lengths are deterministic and must not grow at all. Times only mean
+     * something on the machine that recorded the baseline, so they are gated only with
+     * --tolerance: the fastest new run must exceed the baseline median by the tolerance and
+     * be slower than every baseline run, so a single noisy sample cannot fail the gate. */
+    int regressions = 0;
+    double tolerance = options->tolerance / 100.0;
+    for (int i = 0; i < BENCH_CASE_COUNT; i++) {
+        const BenchResult *result = &results[i];
+        const char *name = result->bench->name;
+        const BaselineEntry *entry = NULL;
+        for (int b = 0; b < baseline_count && !entry; b++) {
+            if (strcmp(baseline[b].name, name) == 0) {
+                entry = &baseline[b];
+            }
+        }
+        if (!entry) {
+            printf("%s: not in baseline\n", name);
+            continue;
+        }
+        if (!result->solved) {
+            printf("REGRESSION %s: no longer solved\n", name);
+            regressions++;
+        }
+        if (result->expanded > entry->expanded) {
+            printf("REGRESSION %s: expanded %lld, baseline %lld (%+.2f%%)\n", name,
+                   result->expanded, entry->expanded,
+                   entry->expanded ? 100.0 * (double)(result->expanded - entry->expanded) /
+                                         (double)entry->expanded
+                                   : 100.0);
+            regressions++;
+        } else if (result->expanded < entry->expanded) {
+            printf("%s: expanded %lld, baseline %lld (improved)\n", name, result->expanded,
+                   entry->expanded);
+        }
+        if (result->length > entry->length) {
+            printf("REGRESSION %s: length %llu, baseline %llu\n", name, result->length,
+                   entry->length);
+            regressions++;
+        } else if (result->length < entry->length) {
+            printf("%s: length %llu, baseline %llu (improved)\n", name, result->length,
+                   entry->length);
+        }
+        if (options->has_tolerance && entry->wall_p50 >= COMPARE_MIN_SECONDS &&
+            result->wall.min > entry->wall_p50 * (1.0 + tolerance) &&
+            result->wall.min > entry->wall_max) {
+            printf("REGRESSION %s: wall time %.4fs min, baseline %.4fs p50 (%+.1f%%, "
+                   "tolerance %.1f%%)\n", name, result->wall.min, entry->wall_p50,
+                   100.0 * (result->wall.min / entry->wall_p50 - 1.0), options->tolerance);
+            regressions++;
+        }
+    }
+    for (int b = 0; b < baseline_count; b++) {
+        bool found = false;
+        for (int i = 0; i < BENCH_CASE_COUNT && !found; i++) {
+            found = strcmp(baseline[b].name, bench_cases[i].name) == 0;
+        }
+        if (!found) {
+            printf("%s: in baseline but no longer benchmarked\n", baseline[b].name);
         }
+    }
+    free(baseline);
+    if (!options->has_tolerance) {
+        printf("Wall times not compared; pass --tolerance PCT on the machine that recorded "
+               "%s.\n", baseline_path);
+    }
 
-        apply_move(state, ctx->n, blank_index, opposite_move(move));
-        *blank_index = prior_blank;
+    if (regressions > 0) {
+        printf("%d regression%s against %s.\n", regressions, regressions == 1 ? "" : "s",
+               baseline_path);
+        return false;
     }
+    printf("No regressions against %s.\n", baseline_path);
+    return true;
+}
 
-    return min;
+static inline uint64_t cycle_counter(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return 0;
+#endif
 }
 
-static void solve_puzzle(int *state, int n, int blank_index) {
-    SearchContext ctx = {
-        .n = n,
-        .len = n * n,
-        .expanded = 0
-    };
+static long long micro_apply_move(MicroFixture *fixture, long long iterations) {
+    static const char cycle[4] = {'U', 'L', 'D', 'R'};
+    for (long long i = 0; i < iterations; i++) {
+        apply_move(fixture->goal, fixture->goal_pos, fixture->rows, fixture->cols,
+                   &fixture->goal_blank, cycle[i & 3]);
+    }
+    return iterations;
+}
 
-    int bound = manhattan_distance(state, n);
-    char *path = malloc(sizeof(char) * (size_t)MAX_ITERATION_BOUND);
-    if (!path) {
-        fprintf(stderr, "Failed to allocate solution path.\n");
-        return;
+static long long micro_manhattan(MicroFixture *fixture, long long iterations) {
+    for (long long i = 0; i < iterations; i++) {
+        fixture->sink += manhattan_distance(fixture->state, fixture->rows, fixture->cols);
     }
+    return iterations;
+}
 
-    while (true) {
-        if (bound > MAX_ITERATION_BOUND) {
-            printf("Search bound exceeded %d. No solution found.\n", MAX_ITERATION_BOUND);
-            break;
+static long long micro_is_goal(MicroFixture *fixture, long long iterations) {
+    for (long long i = 0; i < iterations; i++) {
+        fixture->sink += is_goal(fixture->goal, fixture->len);
+    }
+    return iterations;
+}
+
+static long long micro_inversions(MicroFixture *fixture, long long iterations) {
+    for (long long i = 0; i < iterations; i++) {
+        fixture->sink += inversion_parity(fixture->state, fixture->len, fixture->blank);
+    }
+    return iterations;
+}
+
+static long long micro_read_ini(MicroFixture *fixture, long long iterations) {
+    for (long long i = 0; i < iterations; i++) {
+        int *state = NULL;
+        int *pos = NULL;
+        int rows = 0;
+        int cols = 0;
+        int blank_index = -1;
+        if (read_ini(fixture->ini_path, &state, &pos, &rows, &cols, &blank_index)) {
+            fixture->sink += blank_index;
+            mem_free(state);
+            mem_free(pos);
         }
-        int result = ida_search(&ctx, state, &blank_index, 0, bound, '\0', path);
-        if (result == -1) {
-            printf("Shortest solution length: %d moves\n", bound);
-            printf("Tiles out of place: %d\n", count_misplaced(state, ctx.len));
-            write_moves("move.txt", path, (size_t)bound);
+    }
+    return iterations;
+}
+
+static long long micro_read_moves(MicroFixture *fixture, long long iterations) {
+    long long moves = 0;
+    for (long long i = 0; i < iterations; i++) {
+        MappedFile file;
+        if (!map_file(fixture->moves_path, &file)) {
+            continue;
+        }
+        MoveReader reader;
+        move_reader_init(&reader, file.data, file.size);
+        char move;
+        while (next_move(&reader, &move)) {
+            fixture->sink += move;
+            moves++;
+        }
+        unmap_file(&file);
+    }
+    return moves > 0 ? moves : 1;
+}
+
+static long long micro_write_moves(MicroFixture *fixture, long long iterations) {
+    for (long long i = 0; i < iterations; i++) {
+        write_moves(fixture->out_path, fixture->moves, fixture->move_count);
+    }
+    return iterations * (long long)fixture->move_count;
+}
+
+static const MicroPrimitive micro_primitives[] = {
+    {"apply_move", micro_apply_move},
+    {"manhattan_distance", micro_manhattan},
+    {"is_goal", micro_is_goal},
+    {"count_inversions", micro_inversions},
+    {"read_ini", micro_read_ini},
+    {"read_moves", micro_read_moves},
+    {"write_moves", micro_write_moves}
+};
+
+static int compare_micro_samples(const void *lhs, const void *rhs) {
+    const double *a = lhs;
+    const double *b = rhs;
+    return (a[0] > b[0]) - (a[0] < b[0]);
+}
+
+/* Warm up, grow the batch until it runs for MICRO_MIN_SECONDS, then keep the median batch. */
+static void micro_measure(MicroFixture *fixture, const MicroPrimitive *primitive,
+                          double *ns_per_op, double *cycles_per_op) {
+    for (int i = 0; i < MICRO_WARMUP_RUNS; i++) {
+        primitive->body(fixture, 4);
+    }
+    long long iterations = 4;
+    while (iterations < (1LL << 40)) {
+        double started = monotonic_seconds();
+        primitive->body(fixture, iterations);
+        if (monotonic_seconds() - started >= MICRO_MIN_SECONDS) {
             break;
         }
-        if (result == INT_MAX) {
-            printf("No solution found.\n");
+        iterations *= 2;
+    }
+
+    double samples[MICRO_REPEATS][2];
+    for (int r = 0; r < MICRO_REPEATS; r++) {
+        double started = monotonic_seconds();
+        uint64_t cycles = cycle_counter();
+        long long ops = primitive->body(fixture, iterations);
+        cycles = cycle_counter() - cycles;
+        double elapsed = monotonic_seconds() - started;
+        samples[r][0] = elapsed * 1e9 / (double)ops;
+        samples[r][1] = (double)cycles / (double)ops;
+    }
+    qsort(samples, MICRO_REPEATS, sizeof(samples[0]), compare_micro_samples);
+    *ns_per_op = samples[MICRO_REPEATS / 2][0];
+    *cycles_per_op = samples[MICRO_REPEATS / 2][1];
+}
+
+static bool micro_fixture_init(MicroFixture *fixture, int n, const char *dir) {
+    *fixture = (MicroFixture){.rows = n, .cols = n, .len = n * n};
+    size_t len = (size_t)fixture->len;
+    fixture->state = malloc(sizeof(int) * len);
+    fixture->goal = malloc(sizeof(int) * len);
+    fixture->goal_pos = malloc(sizeof(int) * len);
+    fixture->move_count = MICRO_MOVE_COUNT;
+    fixture->moves = malloc(fixture->move_count);
+    if (!fixture->state || !fixture->goal || !fixture->goal_pos || !fixture->moves) {
+        fprintf(stderr, "Failed to allocate microbenchmark fixture.\n");
+        return false;
+    }
+
+    Rng rng;
+    rng_seed(&rng, (uint64_t)n);
+    if (!shuffle_state(fixture->state, n, n, &rng, &fixture->blank)) {
+        return false;
+    }
+    for (size_t i = 0; i < len; i++) {
+        fixture->goal[i] = i + 1 < len ? (int)i : -1;
+        fixture->goal_pos[i] = (int)i;
+    }
+    fixture->goal_blank = fixture->len - 1;
+    static const char cycle[4] = {'U', 'L', 'D', 'R'};
+    for (size_t i = 0; i < fixture->move_count; i++) {
+        fixture->moves[i] = cycle[i & 3];
+    }
+
+    snprintf(fixture->ini_path, sizeof(fixture->ini_path), "%s/ini.txt", dir);
+    snprintf(fixture->moves_path, sizeof(fixture->moves_path), "%s/move.txt", dir);
+    snprintf(fixture->out_path, sizeof(fixture->out_path), "%s/out.txt", dir);
+    if (!write_ini_file(fixture->ini_path, fixture->state, n, n)) {
+        return false;
+    }
+    write_moves(fixture->moves_path, fixture->moves, fixture->move_count);
+    return true;
+}
+
+static void micro_fixture_free(MicroFixture *fixture) {
+    unlink(fixture->ini_path);
+    unlink(fixture->moves_path);
+    unlink(fixture->out_path);
+    free(fixture->state);
+    free(fixture->goal);
+    free(fixture->goal_pos);
+    free(fixture->moves);
+}
+
+static bool run_microbench(const int *sizes, int size_count) {
+    const char *tmp = getenv("TMPDIR");
+    char dir[PATH_MAX - 16];
+    snprintf(dir, sizeof(dir), "%s/puzzle-micro-XXXXXX", tmp && *tmp ? tmp : "/tmp");
+    if (!mkdtemp(dir)) {
+        fprintf(stderr, "Failed to create %s: %s\n", dir, strerror(errno));
+        return false;
+    }
+
+    bool ok = true;
+    printf("%-20s %6s %14s %14s\n", "primitive", "size", "ns/op", "cycles/op");
+    for (int s = 0; s < size_count && ok; s++) {
+        MicroFixture fixture;
+        ok = micro_fixture_init(&fixture, sizes[s], dir);
+        int count = (int)(sizeof(micro_primitives) / sizeof(micro_primitives[0]));
+        for (int p = 0; p < count && ok; p++) {
+            double ns_per_op = 0.0;
+            double cycles_per_op = 0.0;
+            micro_measure(&fixture, &micro_primitives[p], &ns_per_op, &cycles_per_op);
+            printf("%-20s %6d %14.2f %14.1f\n", micro_primitives[p].name, sizes[s], ns_per_op,
+                   cycles_per_op);
+            fflush(stdout);
+        }
+        micro_fixture_free(&fixture);
+    }
+    rmdir(dir);
+    return ok;
+}
+
+static bool parse_board_size(const char *arg, int *rows, int *cols) {
+    char *end = NULL;
+    long height = strtol(arg, &end, 10);
+    long width = height;
+    if (end != arg && (*end == 'x' || *end == 'X')) {
+        const char *rest = end + 1;
+        width = strtol(rest, &end, 10);
+        if (end == rest) {
+            width = 0;
+        }
+    }
+    if (end == arg || *end != '\0' || height < 2 || width < 2 || height > MAX_PUZZLE_SIZE ||
+        width > MAX_PUZZLE_SIZE) {
+        fprintf(stderr, "Puzzle size must be N or RxC with sides between 2 and %d.\n",
+                MAX_PUZZLE_SIZE);
+        return false;
+    }
+    *rows = (int)height;
+    *cols = (int)width;
+    return true;
+}
+
+static bool parse_options(int *argc, char **argv, Options *options) {
+    int kept = 1;
+    for (int i = 1; i < *argc; i++) {
+        const char *arg = argv[i];
+        if (strncmp(arg, "--", 2) != 0) {
+            argv[kept++] = argv[i];
+            continue;
+        }
+        if (i + 1 >= *argc) {
+            fprintf(stderr, "Missing value for %s.\n", arg);
+            return false;
+        }
+        const char *value = argv[++i];
+        if (strcmp(arg, "--checkpoint") == 0) {
+            options->checkpoint_path = value;
+        } else if (strcmp(arg, "--checkpoint-interval") == 0) {
+            options->checkpoint_interval = atof(value);
+            if (options->checkpoint_interval <= 0) {
+                fprintf(stderr, "Checkpoint interval must be positive.\n");
+                return false;
+            }
+        } else if (strcmp(arg, "--cache") == 0) {
+            options->cache_dir = value;
+        } else if (strcmp(arg, "--cache-size") == 0) {
+            char *end = NULL;
+            options->cache_limit = strtoull(value, &end, 10);
+            if (*end == 'K' || *end == 'k') {
+                options->cache_limit <<= 10;
+            } else if (*end == 'M' || *end == 'm') {
+                options->cache_limit <<= 20;
+            } else if (*end == 'G' || *end == 'g') {
+                options->cache_limit <<= 30;
+            } else if (*end != '\0' || end == value) {
+                fprintf(stderr, "Invalid cache size: %s\n", value);
+                return false;
+            }
+        } else if (strcmp(arg, "--tt") == 0) {
+            options->table_path = value;
+        } else if (strcmp(arg, "--tt-bits") == 0) {
+            options->table_bits = atoi(value);
+            if (options->table_bits < 10 || options->table_bits > 32) {
+                fprintf(stderr, "Transposition table bits must be between 10 and 32.\n");
+                return false;
+            }
+        } else if (strcmp(arg, "--seed") == 0) {
+            char *end = NULL;
+            errno = 0;
+            options->seed = strtoull(value, &end, 0);
+            if (errno != 0 || end == value || *end != '\0') {
+                fprintf(stderr, "Invalid seed: %s\n", value);
+                return false;
+            }
+            options->has_seed = true;
+        } else if (strcmp(arg, "--out") == 0) {
+            options->out_dir = value;
+        } else if (strcmp(arg, "--pack") == 0) {
+            options->pack_path = value;
+        } else if (strcmp(arg, "--report") == 0) {
+            options->report_path = value;
+        } else if (strcmp(arg, "--iterations") == 0) {
+            options->iterations_path = value;
+        } else if (strcmp(arg, "--tolerance") == 0) {
+            options->tolerance = atof(value);
+            options->has_tolerance = true;
+            if (options->tolerance < 0) {
+                fprintf(stderr, "Tolerance must not be negative.\n");
+                return false;
+            }
+        } else if (strcmp(arg, "--memory") == 0) {
+            options->memory_path = value;
+        } else if (strcmp(arg, "--trace") == 0) {
+            options->trace_path = value;
+        } else if (strcmp(arg, "--progress") == 0) {
+            options->progress_interval = atof(value);
+            if (options->progress_interval <= 0) {
+                fprintf(stderr, "Progress interval must be positive.\n");
+                return false;
+            }
+        } else if (strcmp(arg, "--ida-seconds") == 0) {
+            options->ida_seconds = atof(value);
+            if (options->ida_seconds <= 0) {
+                fprintf(stderr, "IDA* time limit must be positive.\n");
+                return false;
+            }
+        } else if (strcmp(arg, "--solver") == 0) {
+            if (strcmp(value, "auto") == 0) {
+                options->solver = SOLVER_AUTO;
+            } else if (strcmp(value, "ida") == 0) {
+                options->solver = SOLVER_IDA;
+            } else if (strcmp(value, "constructive") == 0) {
+                options->solver = SOLVER_CONSTRUCTIVE;
+            } else {
+                fprintf(stderr, "Unknown solver: %s\n", value);
+                return false;
+            }
+        } else {
+            fprintf(stderr, "Unknown option: %s\n", arg);
+            return false;
+        }
+    }
+    argv[kept] = NULL;
+    *argc = kept;
+    return true;
+}
+
+static bool append_keyframe(KeyframeWriter *writer, const int *state, int blank_index,
+                            uint64_t move_offset, uint64_t move_line) {
+    if (writer->count == writer->capacity) {
+        size_t capacity = writer->capacity ? writer->capacity * 2 : 64;
+        KeyframeEntry *entries = mem_realloc(MEM_REPLAY, writer->entries,
+                                             sizeof(KeyframeEntry) * capacity);
+        if (!entries) {
+            return false;
+        }
+        writer->entries = entries;
+        writer->capacity = capacity;
+    }
+
+    KeyframeEntry *entry = &writer->entries[writer->count];
+    entry->data_offset = writer->offset;
+    entry->move_offset = move_offset;
+    entry->move_line = move_line;
+    entry->blank_index = blank_index;
+
+    if (writer->count % KEYFRAME_FULL_PERIOD == 0) {
+        size_t size = sizeof(int32_t) * (size_t)writer->len;
+        entry->delta_count = UINT32_MAX;
+        output_bytes(&writer->out, state, size);
+        memcpy(writer->snapshot, state, size);
+        writer->offset += size;
+    } else {
+        uint32_t changed = 0;
+        for (size_t i = 0; i < writer->dirty_count; i++) {
+            int pos = writer->dirty[i];
+            if (writer->snapshot[pos] != state[pos]) {
+                int32_t pair[2] = {pos, state[pos]};
+                output_bytes(&writer->out, pair, sizeof(pair));
+                writer->snapshot[pos] = state[pos];
+                changed++;
+            }
+        }
+        entry->delta_count = changed;
+        writer->offset += sizeof(int32_t) * 2 * changed;
+    }
+
+    writer->count++;
+    writer->dirty[0] = blank_index;
+    writer->dirty_count = 1;
+    return !writer->out.failed;
+}
+
+static bool build_keyframe_index(const char *moves_path, const char *index_path, int *state,
+                                 int rows, int cols, int blank_index, int interval) {
+    MappedFile file;
+    if (!map_file(moves_path, &file)) {
+        fprintf(stderr, "Failed to open %s: %s\n", moves_path, strerror(errno));
+        return false;
+    }
+
+    int len = rows * cols;
+    uint64_t initial_hash = hash_state(state, len);
+    char temp_path[PATH_MAX];
+    snprintf(temp_path, sizeof(temp_path), "%s.tmp", index_path);
+
+    KeyframeWriter writer = {.len = len};
+    writer.snapshot = mem_alloc(MEM_REPLAY, sizeof(int) * (size_t)len);
+    writer.dirty = mem_alloc(MEM_REPLAY, sizeof(int) * ((size_t)interval + 1));
+    if (!writer.snapshot || !writer.dirty || !output_open(&writer.out, temp_path)) {
+        fprintf(stderr, "Failed to write %s: %s\n", temp_path, strerror(errno));
+        mem_free(writer.snapshot);
+        mem_free(writer.dirty);
+        unmap_file(&file);
+        return false;
+    }
+
+    MoveReader reader;
+    move_reader_init(&reader, file.data, file.size);
+    bool ok = append_keyframe(&writer, state, blank_index, 0, 0);
+    uint64_t move_count = 0;
+    char move;
+    while (ok && next_move(&reader, &move)) {
+        if (!apply_move(state, NULL, rows, cols, &blank_index, move)) {
+            fprintf(stderr, "Invalid move at line %zu.\n", reader.line);
+            ok = false;
             break;
         }
-        bound = result;
+        writer.dirty[writer.dirty_count++] = blank_index;
+        move_count++;
+        if (move_count % (uint64_t)interval == 0) {
+            ok = append_keyframe(&writer, state, blank_index,
+                                 (uint64_t)(reader.cursor - file.data), reader.line);
+        }
+    }
+
+    if (ok) {
+        KeyframeTrailer trailer = {
+            .table_offset = writer.offset,
+            .frame_count = writer.count,
+            .move_count = move_count,
+            .moves_size = file.size,
+            .moves_mtime = file.mtime,
+            .state_hash = initial_hash,
+            .rows = (uint32_t)rows,
+            .cols = (uint32_t)cols,
+            .interval = (uint32_t)interval
+        };
+        memcpy(trailer.magic, KEYFRAME_MAGIC, sizeof(trailer.magic));
+        output_bytes(&writer.out, writer.entries, sizeof(KeyframeEntry) * writer.count);
+        output_bytes(&writer.out, &trailer, sizeof(trailer));
+    }
+    bool written = output_close(&writer.out);
+    if (ok && !written) {
+        fprintf(stderr, "Failed to write %s: %s\n", temp_path, strerror(errno));
+    }
+    ok = ok && written;
+    if (ok && rename(temp_path, index_path) != 0) {
+        fprintf(stderr, "Failed to rename %s: %s\n", temp_path, strerror(errno));
+        ok = false;
+    }
+    if (!ok) {
+        unlink(temp_path);
+    } else {
+        printf("Indexed %llu moves in %zu keyframes (every %d moves) to %s.\n",
+               (unsigned long long)move_count, writer.count, interval, index_path);
+    }
+
+    mem_free(writer.entries);
+    mem_free(writer.snapshot);
+    mem_free(writer.dirty);
+    unmap_file(&file);
+    return ok;
+}
+
+/*
+ * The trailer follows variable-length keyframe data, so it is copied out rather than read in
+ * place. A move file with a different size or modification time makes the index stale.
+ */
+static bool load_keyframe_trailer(const MappedFile *index, const int *state, int rows, int cols,
+                                  const MappedFile *moves, KeyframeTrailer *trailer) {
+    if (index->size < sizeof(KeyframeTrailer)) {
+        return false;
+    }
+    memcpy(trailer, index->data + index->size - sizeof(KeyframeTrailer), sizeof(*trailer));
+    if (memcmp(trailer->magic, KEYFRAME_MAGIC, sizeof(trailer->magic)) != 0 ||
+        trailer->rows != (uint32_t)rows || trailer->cols != (uint32_t)cols ||
+        trailer->interval == 0 || trailer->frame_count == 0 ||
+        trailer->moves_size != moves->size || trailer->moves_mtime != moves->mtime ||
+        trailer->state_hash != hash_state(state, rows * cols)) {
+        return false;
+    }
+    size_t table_end = index->size - sizeof(KeyframeTrailer);
+    return trailer->table_offset <= table_end &&
+           trailer->frame_count ==
+               (table_end - trailer->table_offset) / sizeof(KeyframeEntry);
+}
+
+static bool seek_keyframe(const MappedFile *index, const KeyframeTrailer *trailer,
+                          uint64_t frame, int *state, int len, int *blank_index,
+                          MoveReader *reader, const MappedFile *moves) {
+    KeyframeEntry entries[KEYFRAME_FULL_PERIOD];
+    uint64_t first = frame - frame % KEYFRAME_FULL_PERIOD;
+    memcpy(entries, index->data + trailer->table_offset + first * sizeof(KeyframeEntry),
+           sizeof(KeyframeEntry) * (size_t)(frame - first + 1));
+
+    const KeyframeEntry *full = &entries[0];
+    if (full->delta_count != UINT32_MAX ||
+        full->data_offset + sizeof(int32_t) * (size_t)len > trailer->table_offset) {
+        return false;
+    }
+    memcpy(state, index->data + full->data_offset, sizeof(int32_t) * (size_t)len);
+    for (uint64_t i = 1; i <= frame - first; i++) {
+        const KeyframeEntry *entry = &entries[i];
+        if (entry->data_offset + sizeof(int32_t) * 2 * (uint64_t)entry->delta_count >
+            trailer->table_offset) {
+            return false;
+        }
+        const char *pairs = index->data + entry->data_offset;
+        for (uint32_t d = 0; d < entry->delta_count; d++) {
+            int32_t pair[2];
+            memcpy(pair, pairs + sizeof(pair) * d, sizeof(pair));
+            if (pair[0] < 0 || pair[0] >= len) {
+                return false;
+            }
+            state[pair[0]] = pair[1];
+        }
+    }
+
+    const KeyframeEntry *target = &entries[frame - first];
+    if (target->move_offset > moves->size) {
+        return false;
+    }
+    *blank_index = target->blank_index;
+    move_reader_init(reader, moves->data, moves->size);
+    reader->cursor = moves->data + target->move_offset;
+    reader->line = (size_t)target->move_line;
+    return true;
+}
+
+static bool load_step(const char *moves_path, const char *index_path, int *state, int rows,
+                      int cols, int *blank_index, uint64_t step) {
+    MappedFile moves;
+    if (!map_file(moves_path, &moves)) {
+        fprintf(stderr, "Failed to open %s: %s\n", moves_path, strerror(errno));
+        return false;
+    }
+
+    MoveReader reader;
+    move_reader_init(&reader, moves.data, moves.size);
+    uint64_t position = 0;
+    MappedFile index;
+    if (map_file(index_path, &index)) {
+        KeyframeTrailer trailer;
+        bool fresh = load_keyframe_trailer(&index, state, rows, cols, &moves, &trailer);
+        if (fresh && step <= trailer.move_count) {
+            uint64_t frame = step / trailer.interval;
+            if (seek_keyframe(&index, &trailer, frame, state, rows * cols, blank_index, &reader,
+                              &moves)) {
+                position = frame * trailer.interval;
+            } else {
+                fprintf(stderr, "Keyframe index %s is corrupt.\n", index_path);
+                unmap_file(&index);
+                unmap_file(&moves);
+                return false;
+            }
+        } else if (!fresh) {
+            printf("%s is stale; replaying from the start.\n", index_path);
+        }
+        unmap_file(&index);
+    }
+
+    char move;
+    while (position < step) {
+        if (!next_move(&reader, &move)) {
+            fprintf(stderr, "%s has only %llu moves.\n", moves_path,
+                    (unsigned long long)position);
+            unmap_file(&moves);
+            return false;
+        }
+        if (!apply_move(state, NULL, rows, cols, blank_index, move)) {
+            fprintf(stderr, "Invalid move at line %zu.\n", reader.line);
+            unmap_file(&moves);
+            return false;
+        }
+        position++;
     }
 
-    printf("States expanded: %lld\n", ctx.expanded);
-    free(path);
+    unmap_file(&moves);
+    return true;
 }
 
 int main(int argc, char **argv) {
+    Options options = {
+        .checkpoint_path = NULL,
+        .checkpoint_interval = CHECKPOINT_DEFAULT_INTERVAL,
+        .cache_dir = NULL,
+        .cache_limit = CACHE_DEFAULT_LIMIT,
+        .table_path = NULL,
+        .table_bits = TABLE_DEFAULT_BITS,
+        .seed = 0,
+        .has_seed = false,
+        .out_dir = "corpus",
+        .pack_path = NULL,
+        .solver = SOLVER_AUTO,
+        .moves_path = "move.txt",
+        .report_path = NULL,
+        .iterations_path = NULL,
+        .progress_interval = 0.0,
+        .ida_seconds = IDA_ATTEMPT_SECONDS,
+        .search_seconds = 0.0,
+        .tolerance = 0.0,
+        .has_tolerance = false,
+        .trace_path = NULL,
+        .memory_path = NULL,
+        .quiet = false
+    };
+    if (!parse_options(&argc, argv, &options)) {
+        return EXIT_FAILURE;
+    }
+#ifdef PUZZLE_COUNTERS
+    atexit(counters_report);
+#endif
+    if (options.trace_path) {
+        trace_start(options.trace_path);
+    }
+    if (options.memory_path) {
+        memory_report_path = options.memory_path;
+        atexit(memory_report);
+    }
+
     if (argc >= 3 && strcmp(argv[1], "generate") == 0) {
+        int rows = 0;
+        int cols = 0;
+        if (!parse_board_size(argv[2], &rows, &cols)) {
+            return EXIT_FAILURE;
+        }
+        uint64_t seed = options.has_seed ? options.seed : default_seed();
+        if (!generate_ini_file("ini.txt", rows, cols, seed)) {
+            return EXIT_FAILURE;
+        }
+        printf("Generated ini.txt for %dx%d puzzle (seed %llu).\n", rows, cols,
+               (unsigned long long)seed);
+        return EXIT_SUCCESS;
+    }
+
+    if (argc >= 4 && strcmp(argv[1], "generate-batch") == 0) {
         int n = atoi(argv[2]);
-        if (!generate_ini_file("ini.txt", n)) {
+        long long count = atoll(argv[3]);
+        if (n <= 1 || n > MAX_PUZZLE_SIZE || count <= 0) {
+            fprintf(stderr, "Usage: generate-batch N COUNT with 1 < N <= %d and COUNT > 0.\n",
+                    MAX_PUZZLE_SIZE);
+            return EXIT_FAILURE;
+        }
+        uint64_t seed = options.has_seed ? options.seed : default_seed();
+        Corpus corpus = {
+            .kind = CORPUS_UNIFORM,
+            .dir = options.out_dir,
+            .pack_path = options.pack_path,
+            .n = n,
+            .seed = seed,
+            .count = count
+        };
+        if (!generate_corpus(&corpus)) {
+            return EXIT_FAILURE;
+        }
+        printf("Generated %lld %dx%d puzzles in %s (seed %llu).\n", count, n, n,
+               options.pack_path ? options.pack_path : options.out_dir,
+               (unsigned long long)seed);
+        return EXIT_SUCCESS;
+    }
+
+    if (argc >= 4 && strcmp(argv[1], "scramble") == 0) {
+        int rows = 0;
+        int cols = 0;
+        int depth = atoi(argv[3]);
+        long long count = argc >= 5 ? atoll(argv[4]) : 0;
+        if (!parse_board_size(argv[2], &rows, &cols)) {
+            return EXIT_FAILURE;
+        }
+        if (depth < 0 || (argc >= 5 && (count <= 0 || rows != cols))) {
+            fprintf(stderr, "Usage: scramble N DEPTH [COUNT] with COUNT > 0; a single board "
+                            "may be RxC.\n");
+            return EXIT_FAILURE;
+        }
+        uint64_t seed = options.has_seed ? options.seed : default_seed();
+        if (count > 0) {
+            int n = rows;
+            Corpus corpus = {
+                .kind = CORPUS_SCRAMBLE,
+                .dir = options.out_dir,
+                .pack_path = options.pack_path,
+                .n = n,
+                .depth = depth,
+                .seed = seed,
+                .count = count
+            };
+            if (!generate_corpus(&corpus)) {
+                return EXIT_FAILURE;
+            }
+            printf("Generated %lld %dx%d puzzles scrambled by %d moves in %s (seed %llu).\n",
+                   count, n, n, depth, options.pack_path ? options.pack_path : options.out_dir,
+                   (unsigned long long)seed);
+            return EXIT_SUCCESS;
+        }
+
+        int *scrambled = mem_alloc(MEM_BOARD, sizeof(int) * (size_t)rows * (size_t)cols);
+        if (!scrambled) {
+            fprintf(stderr, "Failed to allocate puzzle state.\n");
             return EXIT_FAILURE;
         }
-        printf("Generated ini.txt for %dx%d puzzle.\n", n, n);
+        Rng rng;
+        rng_seed(&rng, seed);
+        int scrambled_blank = 0;
+        scramble_state(scrambled, rows, cols, depth, &rng, &scrambled_blank);
+        bool written = write_ini_file("ini.txt", scrambled, rows, cols);
+        mem_free(scrambled);
+        if (!written) {
+            return EXIT_FAILURE;
+        }
+        printf("Generated ini.txt for %dx%d puzzle scrambled by %d moves (seed %llu).\n", rows,
+               cols, depth, (unsigned long long)seed);
         return EXIT_SUCCESS;
     }
 
+    if (argc >= 2 && strcmp(argv[1], "bench") == 0) {
+        int repeat = argc >= 3 ? atoi(argv[2]) : BENCH_DEFAULT_REPEAT;
+        if (repeat <= 0) {
+            fprintf(stderr, "Usage: bench [REPEAT] with REPEAT > 0.\n");
+            return EXIT_FAILURE;
+        }
+        options.moves_path = "/dev/null";
+        if (!options.report_path) {
+            options.report_path = "bench.json";
+        }
+        return run_bench(repeat, &options) ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    if (argc >= 3 && strcmp(argv[1], "heuristics") == 0) {
+        int rows = 0;
+        int cols = 0;
+        if (!parse_board_size(argv[2], &rows, &cols)) {
+            return EXIT_FAILURE;
+        }
+        int samples = argc >= 4 ? atoi(argv[3]) : PROFILE_DEFAULT_SAMPLES;
+        if (samples <= 0) {
+            fprintf(stderr, "Usage: heuristics N [SAMPLES] with SAMPLES > 0.\n");
+            return EXIT_FAILURE;
+        }
+        return profile_heuristics(rows, cols, samples, &options) ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    if (argc >= 2 && strcmp(argv[1], "bench-compare") == 0) {
+        const char *baseline = argc >= 3 ? argv[2] : BENCH_BASELINE_PATH;
+        int repeat = argc >= 4 ? atoi(argv[3]) : BENCH_DEFAULT_REPEAT;
+        if (repeat <= 0) {
+            fprintf(stderr, "Usage: bench-compare [BASELINE] [REPEAT] with REPEAT > 0.\n");
+            return EXIT_FAILURE;
+        }
+        options.moves_path = "/dev/null";
+        return compare_bench(baseline, repeat, &options) ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    if (argc >= 2 && strcmp(argv[1], "microbench") == 0) {
+        static const int default_sizes[] = {3, 4, 5, 8, 16, 32, 64, 128, 256, 512, 1000};
+        int sizes[sizeof(default_sizes) / sizeof(default_sizes[0])];
+        int size_count = 0;
+        for (int i = 2; i < argc && size_count < (int)(sizeof(sizes) / sizeof(sizes[0])); i++) {
+            sizes[size_count] = atoi(argv[i]);
+            if (sizes[size_count] < 2 || sizes[size_count] > MAX_PUZZLE_SIZE) {
+                fprintf(stderr, "Microbenchmark sizes must be between 2 and %d.\n",
+                        MAX_PUZZLE_SIZE);
+                return EXIT_FAILURE;
+            }
+            size_count++;
+        }
+        if (size_count == 0) {
+            memcpy(sizes, default_sizes, sizeof(default_sizes));
+            size_count = (int)(sizeof(default_sizes) / sizeof(default_sizes[0]));
+        }
+        return run_microbench(sizes, size_count) ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
     int *state = NULL;
-    int n = 0;
+    int *pos = NULL;
+    int rows = 0;
+    int cols = 0;
     int blank_index = -1;
 
-    if (!read_ini("ini.txt", &state, &n, &blank_index)) {
+    double traced = trace_begin();
+    bool loaded = read_ini("ini.txt", &state, &pos, &rows, &cols, &blank_index);
+    trace_end("read_ini", traced, NULL, 0);
+    if (!loaded) {
+        return EXIT_FAILURE;
+    }
+    traced = trace_begin();
+    bool solvable = false;
+    bool checked = is_solvable(state, rows, cols, blank_index, &solvable);
+    trace_end("is_solvable", traced, NULL, 0);
+    if (!checked) {
+        mem_free(state);
+        mem_free(pos);
+        return EXIT_FAILURE;
+    }
+    if (!solvable) {
+        fprintf(stderr, "ini.txt is not solvable: its tile parity cannot reach the goal.\n");
+        mem_free(state);
+        mem_free(pos);
         return EXIT_FAILURE;
     }
 
-    char *moves = NULL;
-    size_t move_count = 0;
-    if (read_moves("move.txt", &moves, &move_count)) {
-        for (size_t i = 0; i < move_count; i++) {
-            if (!apply_move(state, n, &blank_index, moves[i])) {
-                fprintf(stderr, "Invalid move at line %zu.\n", i + 1);
-                free(state);
-                free(moves);
-                return EXIT_FAILURE;
-            }
+    if (argc >= 2 && strcmp(argv[1], "index") == 0) {
+        int interval = argc >= 3 ? atoi(argv[2]) : KEYFRAME_DEFAULT_INTERVAL;
+        if (interval <= 0) {
+            fprintf(stderr, "Keyframe interval must be positive.\n");
+            mem_free(state);
+            mem_free(pos);
+            return EXIT_FAILURE;
+        }
+        bool indexed = build_keyframe_index("move.txt", "move.txt.idx", state, rows, cols,
+                                            blank_index, interval);
+        mem_free(state);
+        mem_free(pos);
+        return indexed ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    if (argc >= 2 && strcmp(argv[1], "estimate") == 0) {
+        int probes = argc >= 3 ? atoi(argv[2]) : ESTIMATE_DEFAULT_PROBES;
+        bool estimated = probes > 0 &&
+                         run_estimate(state, rows, cols, blank_index, probes, &options);
+        if (probes <= 0) {
+            fprintf(stderr, "Probe count must be positive.\n");
+        }
+        mem_free(state);
+        mem_free(pos);
+        return estimated ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    if (argc >= 3 && strcmp(argv[1], "step") == 0) {
+        char *end = NULL;
+        errno = 0;
+        unsigned long long step = strtoull(argv[2], &end, 10);
+        if (errno != 0 || end == argv[2] || *end != '\0' || argv[2][0] == '-') {
+            fprintf(stderr, "Invalid step: %s\n", argv[2]);
+            mem_free(state);
+            mem_free(pos);
+            return EXIT_FAILURE;
+        }
+        traced = trace_begin();
+        bool stepped = load_step("move.txt", "move.txt.idx", state, rows, cols, &blank_index,
+                                 step);
+        trace_end("load_step", traced, "step", (long long)step);
+        if (!stepped) {
+            mem_free(state);
+            mem_free(pos);
+            return EXIT_FAILURE;
         }
+        printf("State after %llu moves:\n", step);
+        print_state(state, rows, cols);
+        printf("Tiles out of place: %d\n", count_misplaced(state, rows * cols));
+        mem_free(state);
+        mem_free(pos);
+        return EXIT_SUCCESS;
+    }
+
+    size_t invalid_line = 0;
+    traced = trace_begin();
+    ReplayResult replay = replay_moves("move.txt", state, pos, rows, cols, &blank_index,
+                                       &invalid_line);
+    trace_end("read_moves", traced, NULL, 0);
+    if (replay == REPLAY_INVALID) {
+        fprintf(stderr, "Invalid move at line %zu.\n", invalid_line);
+        mem_free(state);
+        mem_free(pos);
+        return EXIT_FAILURE;
+    }
+    if (replay == REPLAY_APPLIED) {
         printf("Final state after applying move.txt:\n");
-        print_state(state, n);
-        printf("Tiles out of place: %d\n", count_misplaced(state, n * n));
-        free(moves);
+        print_state(state, rows, cols);
+        printf("Tiles out of place: %d\n", count_misplaced(state, rows * cols));
     } else {
-        printf("move.txt empty or missing. Solving with divide-and-conquer search (IDA*).\n");
-        printf("Initial tiles out of place: %d\n", count_misplaced(state, n * n));
-        solve_puzzle(state, n, blank_index);
+        int len = rows * cols;
+        bool attempt = options.solver == SOLVER_AUTO && len > IDA_MAX_CELLS &&
+                       len <= IDA_ATTEMPT_MAX_CELLS;
+        bool reduce = options.solver == SOLVER_CONSTRUCTIVE ||
+                      (options.solver == SOLVER_AUTO && len > IDA_ATTEMPT_MAX_CELLS);
+        SolveStats stats = {0};
+        /* Mid-sized boards get a bounded IDA* attempt; an aborted search leaves the board
+         * mid-path, so keep a copy for the fallback. */
+        int *saved = attempt ? mem_alloc(MEM_BOARD, sizeof(int) * 2 * (size_t)len) : NULL;
+        if (attempt && !saved) {
+            attempt = false;
+            reduce = true;
+        }
+        if (!reduce) {
+            Options search = options;
+            if (saved) {
+                memcpy(saved, state, sizeof(int) * (size_t)len);
+                memcpy(saved + len, pos, sizeof(int) * (size_t)len);
+                search.search_seconds = options.ida_seconds;
+                printf("move.txt empty or missing. Trying IDA* for up to %.1f seconds.\n",
+                       options.ida_seconds);
+            } else {
+                printf("move.txt empty or missing. Solving with divide-and-conquer search "
+                       "(IDA*).\n");
+            }
+            printf("Initial tiles out of place: %d\n", count_misplaced(state, len));
+            traced = trace_begin();
+            solve_puzzle(state, pos, rows, cols, blank_index, &search, &stats);
+            trace_end("solve_puzzle", traced, "expanded", stats.expanded);
+            if (saved) {
+                if (!stats.solved && !stats.interrupted) {
+                    memcpy(state, saved, sizeof(int) * (size_t)len);
+                    memcpy(pos, saved + len, sizeof(int) * (size_t)len);
+                    reduce = true;
+                }
+                mem_free(saved);
+            }
+        }
+        if (reduce) {
+            if (attempt) {
+                printf("Falling back to row and column reduction (not optimal).\n");
+            } else {
+                printf("move.txt empty or missing. Solving with row and column reduction "
+                       "(not optimal).\n");
+                printf("Initial tiles out of place: %d\n", count_misplaced(state, len));
+            }
+            traced = trace_begin();
+            solve_constructive(state, pos, rows, cols, blank_index, &options, &stats);
+            trace_end("solve_constructive", traced, "moves", (long long)stats.length);
+        }
+        if (stats.interrupted) {
+            /* Report the signal like an unhandled one would, so pipelines see the stop. */
+            mem_free(state);
+            mem_free(pos);
+            return 128 + stats.interrupted;
+        }
     }
 
-    free(state);
+    mem_free(state);
+    mem_free(pos);
     return EXIT_SUCCESS;
 }